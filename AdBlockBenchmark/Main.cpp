@@ -0,0 +1,250 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QElapsedTimer>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <QHash>
+#include <QVector>
+
+#include <QUrl>
+
+#include "Core/AdBlock/Manager.hpp"
+#include "Core/AdBlock/Matcher.hpp"
+#include "Core/AdBlock/RequestContext.hpp"
+#include "Core/AdBlock/Subscription.hpp"
+
+#include "Core/Network/LatencyHistogram.hpp"
+
+/*
+ * Replays a recorded corpus of requests through an ADB::Matcher built from the
+ * given filter lists. It runs without a browser profile nor a window, the lists
+ * are either raw Adblock Plus lists or the files of a profile adblock directory.
+ *
+ * Usage: sielo-adblock-benchmark <corpus> <filter list>... [--iterations <count>]
+ * The corpus has one request per line: url, first party url and resource type,
+ * separated by tabulations. The resource type is either the numeric value of
+ * Engine::UrlRequestInfo::ResourceType or its name ("script", "image", ...).
+ */
+
+struct Request {
+	QUrl url{};
+	QUrl firstPartyUrl{};
+	Engine::UrlRequestInfo::ResourceType resourceType{Engine::UrlRequestInfo::ResourceTypeUnknown};
+};
+
+static Engine::UrlRequestInfo::ResourceType parseResourceType(const QString& value)
+{
+	static const QHash<QString, Engine::UrlRequestInfo::ResourceType> types{
+		{QStringLiteral("main_frame"), Engine::UrlRequestInfo::ResourceTypeMainFrame},
+		{QStringLiteral("sub_frame"), Engine::UrlRequestInfo::ResourceTypeSubFrame},
+		{QStringLiteral("stylesheet"), Engine::UrlRequestInfo::ResourceTypeStylesheet},
+		{QStringLiteral("script"), Engine::UrlRequestInfo::ResourceTypeScript},
+		{QStringLiteral("image"), Engine::UrlRequestInfo::ResourceTypeImage},
+		{QStringLiteral("font"), Engine::UrlRequestInfo::ResourceTypeFontResource},
+		{QStringLiteral("object"), Engine::UrlRequestInfo::ResourceTypeObject},
+		{QStringLiteral("media"), Engine::UrlRequestInfo::ResourceTypeMedia},
+		{QStringLiteral("xhr"), Engine::UrlRequestInfo::ResourceTypeXhr},
+		{QStringLiteral("ping"), Engine::UrlRequestInfo::ResourceTypePing},
+		{QStringLiteral("other"), Engine::UrlRequestInfo::ResourceTypeSubResource}
+	};
+
+	bool isNumber{false};
+	const int number{value.toInt(&isNumber)};
+
+	if (isNumber)
+		return static_cast<Engine::UrlRequestInfo::ResourceType>(number);
+
+	return types.value(value.toLower(), Engine::UrlRequestInfo::ResourceTypeUnknown);
+}
+
+static bool loadCorpus(const QString& filePath, QVector<Request>& requests)
+{
+	QFile file{filePath};
+
+	if (!file.open(QFile::ReadOnly)) {
+		std::cerr << "Unable to open " << filePath.toStdString() << std::endl;
+		return false;
+	}
+
+	QTextStream stream{&file};
+	stream.setCodec("UTF-8");
+
+	while (!stream.atEnd()) {
+		const QStringList fields{stream.readLine().split(QLatin1Char('\t'))};
+
+		if (fields.count() < 3 || fields[0].startsWith(QLatin1Char('#')))
+			continue;
+
+		Request request{};
+		request.url = QUrl(fields[0]);
+		request.firstPartyUrl = QUrl(fields[1]);
+		request.resourceType = parseResourceType(fields[2]);
+
+		if (request.url.isValid())
+			requests.append(request);
+	}
+
+	return !requests.isEmpty();
+}
+
+// Subscriptions expect the title and url lines written by Sielo before the list itself
+static Sn::ADB::Subscription* loadSubscription(const QString& filePath, const QString& copyPath, QObject* parent)
+{
+	QFile file{filePath};
+
+	if (!file.open(QFile::ReadOnly)) {
+		std::cerr << "Unable to open " << filePath.toStdString() << std::endl;
+		return nullptr;
+	}
+
+	const QString title{QFileInfo(filePath).completeBaseName()};
+	QString subscriptionPath{filePath};
+
+	if (file.peek(8).startsWith("[Adblock")) {
+		subscriptionPath = copyPath;
+		QFile copy{subscriptionPath};
+
+		if (!copy.open(QFile::WriteOnly | QFile::Truncate)) {
+			std::cerr << "Unable to write " << subscriptionPath.toStdString() << std::endl;
+			return nullptr;
+		}
+
+		copy.write(QString("Title: %1\nUrl: \n").arg(title).toUtf8());
+		copy.write(file.readAll());
+	}
+
+	Sn::ADB::Subscription* subscription{new Sn::ADB::Subscription(title, parent)};
+	subscription->setFilePath(subscriptionPath);
+	subscription->loadSubscription(QStringList());
+
+	if (subscription->allRulles().isEmpty()) {
+		std::cerr << "No rule found in " << filePath.toStdString() << std::endl;
+		delete subscription;
+		return nullptr;
+	}
+
+	return subscription;
+}
+
+static QString formatLatency(qint64 nanoseconds)
+{
+	return QString::number(static_cast<double>(nanoseconds) / 1000.0, 'f', 2) + QLatin1String(" us");
+}
+
+int main(int argc, char** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	QStringList arguments{QCoreApplication::arguments()};
+	int iterations{5};
+	const int iterationsIndex{arguments.indexOf(QStringLiteral("--iterations"))};
+
+	if (iterationsIndex > 0) {
+		iterations = qMax(1, arguments.value(iterationsIndex + 1).toInt());
+		arguments.erase(arguments.begin() + iterationsIndex, arguments.begin() + qMin(iterationsIndex + 2, arguments.count()));
+	}
+
+	if (arguments.count() < 3) {
+		std::cerr << "Usage: sielo-adblock-benchmark <corpus> <filter list>... [--iterations <count>]" << std::endl;
+		return 1;
+	}
+
+	QVector<Request> requests{};
+
+	if (!loadCorpus(arguments[1], requests)) {
+		std::cerr << "The corpus is empty" << std::endl;
+		return 1;
+	}
+
+	QTemporaryDir directory{};
+	QList<Sn::ADB::Subscription*> subscriptions{};
+
+	if (!directory.isValid()) {
+		std::cerr << "Unable to create a temporary directory" << std::endl;
+		return 1;
+	}
+
+	for (int i{2}; i < arguments.count(); ++i) {
+		Sn::ADB::Subscription* subscription{loadSubscription(arguments[i], directory.filePath(QString::number(i) + QLatin1String(".txt")), &app)};
+
+		if (!subscription)
+			return 1;
+
+		subscriptions.append(subscription);
+	}
+
+	Sn::ADB::Matcher matcher{subscriptions};
+
+	// Rules are compiled on a worker thread
+	QEventLoop loop{};
+	QObject::connect(&matcher, &Sn::ADB::Matcher::updated, &loop, &QEventLoop::quit);
+	matcher.update();
+	loop.exec();
+
+	Sn::LatencyHistogram latency{};
+	QElapsedTimer timer{};
+	qint64 totalTime{0};
+	qint64 blocked{0};
+
+	for (int iteration{0}; iteration < iterations; ++iteration) {
+		foreach (const Request& request, requests) {
+			Engine::UrlRequestInfo info{request.url, request.firstPartyUrl, request.resourceType};
+
+			// Same work as ADB::Manager::block, without the redirection of blocked main frames
+			timer.start();
+			Sn::ADB::RequestContext& context{Sn::ADB::RequestContext::local()};
+			context.reset(info);
+
+			const bool isBlocked{Sn::ADB::Manager::canRunOnScheme(context.scheme()) && matcher.match(context)};
+			const qint64 elapsed{timer.nsecsElapsed()};
+
+			latency.record(elapsed);
+			totalTime += elapsed;
+
+			if (isBlocked)
+				++blocked;
+		}
+	}
+
+	const quint64 count{latency.count()};
+
+	std::cout << "Requests:   " << requests.count() << " x " << iterations << std::endl;
+	std::cout << "Blocked:    " << blocked / iterations << " per iteration" << std::endl;
+	std::cout << "Mean:       " << formatLatency(totalTime / static_cast<qint64>(count)).toStdString() << std::endl;
+	std::cout << "p50:        " << formatLatency(latency.percentile(0.5)).toStdString() << std::endl;
+	std::cout << "p99:        " << formatLatency(latency.percentile(0.99)).toStdString() << std::endl;
+	std::cout << "Throughput: " << static_cast<qint64>(count * 1000000000.0 / qMax<qint64>(totalTime, 1))
+			  << " requests/s" << std::endl;
+
+	return 0;
+}
@@ -97,6 +97,7 @@ bool CustomList::removeFilter(const QString& filter)
 
 int CustomList::addRule(Rule* rule)
 {
+	adoptRule(rule);
 	m_rules.append(rule);
 
 	emit subscriptionChanged();
@@ -114,18 +115,18 @@ bool CustomList::removeRule(int offset)
 
 	Rule* rule{m_rules[offset]};
 	const QString filter{rule->filter()};
+	const bool isCSSRule{rule->isCSSRule()};
 
 	m_rules.remove(offset);
+	retireRule(rule);
 
 	emit subscriptionChanged();
 
-	if (rule->isCSSRule())
+	if (isCSSRule)
 		Application::instance()->reloadUserStyleSheet();
 
 	Manager::instance()->removeDisabledRule(filter);
 
-	delete rule;
-
 	return true;
 }
 
@@ -134,7 +135,8 @@ const Rule* CustomList::replaceRule(Rule* rule, int offset)
 	if (!(offset >= 0 && m_rules.count() > offset))
 		return nullptr;
 
-	Rule* oldRule{m_rules[offset]};
+	adoptRule(rule);
+	retireRule(m_rules[offset]);
 	m_rules[offset] = rule;
 
 	emit subscriptionChanged();
@@ -142,8 +144,6 @@ const Rule* CustomList::replaceRule(Rule* rule, int offset)
 	if (rule->isCSSRule())
 		Application::instance()->reloadUserStyleSheet();
 
-	delete oldRule;
-
 	return m_rules[offset];
 }
 
@@ -0,0 +1,294 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "AdBlock/FilterCache.hpp"
+
+#include <QCryptographicHash>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <QDateTime>
+
+#include <QtDebug>
+
+#include "Utils/DataPaths.hpp"
+
+#include "AdBlock/Manager.hpp"
+#include "AdBlock/Matcher.hpp"
+#include "AdBlock/Rule.hpp"
+#include "AdBlock/Subscription.hpp"
+
+namespace Sn {
+namespace ADB {
+
+static const quint32 FILTER_CACHE_MAGIC = 0x534e4142;
+static const quint32 FILTER_CACHE_VERSION = 1;
+
+QString FilterCache::filePath()
+{
+	return DataPaths::currentProfilePath() + QLatin1String("/adblock/filters.cache");
+}
+
+bool FilterCache::load(Manager* manager, Matcher* matcher)
+{
+	const QByteArray key{sourcesKey(manager)};
+
+	if (key.isEmpty())
+		return false;
+
+	QFile file{filePath()};
+
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	const qint64 size{file.size()};
+	uchar* data{file.map(0, size)};
+
+	if (!data)
+		return false;
+
+	const QByteArray mapped{QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(size))};
+	QDataStream header{mapped};
+	header.setVersion(QDataStream::Qt_5_11);
+
+	quint32 magic{0};
+	quint32 version{0};
+	QByteArray storedKey{};
+	QByteArray checksum{};
+	quint32 payloadSize{0};
+
+	header >> magic >> version;
+
+	if (magic != FILTER_CACHE_MAGIC || version != FILTER_CACHE_VERSION)
+		return false;
+
+	header >> storedKey >> checksum >> payloadSize;
+
+	const qint64 offset{header.device()->pos()};
+
+	if (header.status() != QDataStream::Ok || storedKey != key || offset + payloadSize > size)
+		return false;
+
+	const QByteArray payload{QByteArray::fromRawData(mapped.constData() + offset, static_cast<int>(payloadSize))};
+
+	if (QCryptographicHash::hash(payload, QCryptographicHash::Sha1) != checksum) {
+		qWarning() << "ADB::FilterCache: Checksum mismatch in " << file.fileName();
+		return false;
+	}
+
+	QDataStream stream{payload};
+	stream.setVersion(QDataStream::Qt_5_11);
+
+	const QList<Subscription*> subscriptions{manager->subscriptions()};
+	QVector<QVector<Rule*>> subscriptionsRules{};
+	QVector<const Rule*> rules{};
+	qint32 subscriptionsCount{0};
+
+	stream >> subscriptionsCount;
+
+	if (subscriptionsCount != subscriptions.count())
+		return false;
+
+	auto discard = [&subscriptionsRules]() {
+		for (const QVector<Rule*>& subscriptionRules : subscriptionsRules)
+			qDeleteAll(subscriptionRules);
+
+		return false;
+	};
+
+	for (Subscription* subscription : subscriptions) {
+		qint32 rulesCount{0};
+		stream >> rulesCount;
+
+		if (rulesCount < 0 || stream.status() != QDataStream::Ok)
+			return discard();
+
+		QVector<Rule*> subscriptionRules{};
+		subscriptionRules.reserve(rulesCount);
+
+		for (qint32 i{0}; i < rulesCount; ++i) {
+			Rule* rule{new Rule(QString(), subscription)};
+			stream >> *rule;
+
+			subscriptionRules.append(rule);
+			rules.append(rule);
+		}
+
+		subscriptionsRules.append(subscriptionRules);
+
+		if (stream.status() != QDataStream::Ok)
+			return discard();
+	}
+
+	for (int i{0}; i < subscriptions.count(); ++i)
+		subscriptions[i]->setRules(subscriptionsRules[i]);
+
+	// The subscriptions own the rules from here, a failure only leaves the matcher empty
+	if (!matcher->loadState(stream, rules))
+		return false;
+
+	return true;
+}
+
+bool FilterCache::save(Manager* manager, const Matcher* matcher)
+{
+	const QByteArray key{sourcesKey(manager)};
+
+	if (key.isEmpty() || key == storedKey())
+		return false;
+
+	const QList<Subscription*> subscriptions{manager->subscriptions()};
+
+	// A subscription still waiting for its list must be parsed again at next start
+	for (const Subscription* subscription : subscriptions) {
+		if (!subscription->canEditRules() && subscription->allRulles().isEmpty())
+			return false;
+	}
+
+	QByteArray payload{};
+	QDataStream stream{&payload, QIODevice::WriteOnly};
+	stream.setVersion(QDataStream::Qt_5_11);
+
+	QHash<const Rule*, qint32> ruleIds{};
+
+	stream << static_cast<qint32>(subscriptions.count());
+
+	for (const Subscription* subscription : subscriptions) {
+		const QVector<Rule*> subscriptionRules{subscription->allRulles()};
+
+		stream << static_cast<qint32>(subscriptionRules.count());
+
+		for (const Rule* rule : subscriptionRules) {
+			ruleIds.insert(rule, ruleIds.count());
+			stream << *rule;
+		}
+	}
+
+	matcher->saveState(stream, ruleIds);
+
+	QSaveFile file{filePath()};
+
+	if (!file.open(QIODevice::WriteOnly)) {
+		qWarning() << "ADB::FilterCache: Unable to open cache file for writing " << file.fileName();
+		return false;
+	}
+
+	QDataStream header{&file};
+	header.setVersion(QDataStream::Qt_5_11);
+
+	header << FILTER_CACHE_MAGIC << FILTER_CACHE_VERSION;
+	header << key << QCryptographicHash::hash(payload, QCryptographicHash::Sha1);
+	header << static_cast<quint32>(payload.size());
+	header.writeRawData(payload.constData(), payload.size());
+
+	return file.commit();
+}
+
+void FilterCache::writeRuleIds(QDataStream& stream, const QVector<const Rule*>& list,
+							   const QHash<const Rule*, qint32>& ruleIds)
+{
+	stream << static_cast<qint32>(list.count());
+
+	for (const Rule* rule : list)
+		stream << ruleIds.value(rule, -1);
+}
+
+bool FilterCache::readRuleIds(QDataStream& stream, QVector<const Rule*>& list, const QVector<const Rule*>& rules)
+{
+	qint32 count{0};
+	stream >> count;
+
+	if (count < 0 || stream.status() != QDataStream::Ok)
+		return false;
+
+	list.reserve(count);
+
+	for (qint32 i{0}; i < count; ++i) {
+		qint32 id{-1};
+		stream >> id;
+
+		if (id < 0 || id >= rules.count())
+			return false;
+
+		list.append(rules[id]);
+	}
+
+	return stream.status() == QDataStream::Ok;
+}
+
+QByteArray FilterCache::sourcesKey(Manager* manager)
+{
+	QCryptographicHash hash{QCryptographicHash::Sha1};
+
+	hash.addData(QByteArray::number(FILTER_CACHE_VERSION));
+	hash.addData(QByteArray::number(QT_VERSION));
+
+	foreach (const Subscription* subscription, manager->subscriptions()) {
+		const QFileInfo info{subscription->filePath()};
+
+		if (!info.exists())
+			return QByteArray();
+
+		hash.addData(subscription->title().toUtf8());
+		hash.addData(info.absoluteFilePath().toUtf8());
+		hash.addData(QByteArray::number(info.size()));
+		hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+	}
+
+	foreach (const QString& filter, manager->disabledRules()) {
+		hash.addData(filter.toUtf8());
+		hash.addData("\n", 1);
+	}
+
+	return hash.result();
+}
+
+QByteArray FilterCache::storedKey()
+{
+	QFile file{filePath()};
+
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+
+	QDataStream stream{&file};
+	stream.setVersion(QDataStream::Qt_5_11);
+
+	quint32 magic{0};
+	quint32 version{0};
+	QByteArray key{};
+
+	stream >> magic >> version;
+
+	if (magic != FILTER_CACHE_MAGIC || version != FILTER_CACHE_VERSION)
+		return QByteArray();
+
+	stream >> key;
+
+	return key;
+}
+
+}
+}
@@ -0,0 +1,74 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_ADBFILTERCACHE_HPP
+#define SIELOBROWSER_ADBFILTERCACHE_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QDataStream>
+#include <QHash>
+#include <QVector>
+
+#include <QByteArray>
+#include <QString>
+
+namespace Sn {
+namespace ADB {
+class Manager;
+
+class Matcher;
+
+class Rule;
+
+/*
+ * Binary snapshot of the parsed subscriptions and of the compiled matcher. It is
+ * keyed on the size and modification time of every subscription file plus the
+ * disabled rules, so any change on disk falls back to the text parsing.
+ *
+ * Loading skips the filter parsing and the index building, but every rule is
+ * still allocated and its strings copied out of the mapped file. Regular
+ * expressions are only compiled when a rule is first matched.
+ */
+class SIELO_SHAREDLIB FilterCache {
+public:
+	static QString filePath();
+
+	static bool load(Manager* manager, Matcher* matcher);
+	static bool save(Manager* manager, const Matcher* matcher);
+
+	static void writeRuleIds(QDataStream& stream, const QVector<const Rule*>& list,
+							 const QHash<const Rule*, qint32>& ruleIds);
+	static bool readRuleIds(QDataStream& stream, QVector<const Rule*>& list, const QVector<const Rule*>& rules);
+
+private:
+	static QByteArray sourcesKey(Manager* manager);
+	static QByteArray storedKey();
+};
+
+}
+}
+
+#endif //SIELOBROWSER_ADBFILTERCACHE_HPP
@@ -40,9 +40,13 @@
 #include "Utils/DataPaths.hpp"
 #include "Utils/Settings.hpp"
 
+#include "Web/Scripts.hpp"
+
 #include "AdBlock/Rule.hpp"
 #include "AdBlock/Matcher.hpp"
 #include "AdBlock/CustomList.hpp"
+#include "AdBlock/FilterCache.hpp"
+#include "AdBlock/RequestContext.hpp"
 #include "AdBlock/Subscription.hpp"
 #include "AdBlock/UrlInterceptor.hpp"
 
@@ -59,12 +63,17 @@ Manager::Manager(QObject* parent) :
 		m_matcher(new Matcher(this)),
 		m_interceptor(new UrlInterceptor(this))
 {
+	connect(m_matcher, &Matcher::updated, this, &Manager::matcherUpdated);
+	connect(m_matcher, &Matcher::updated, this, &Manager::updateElementHidingScript);
+	connect(this, &Manager::enabledChanged, this, &Manager::updateElementHidingScript);
+
 	load();
 }
 
 Manager::~Manager()
 {
 	qDeleteAll(m_subscriptions);
+	qDeleteAll(m_removedSubscriptions);
 }
 
 Manager* Manager::instance()
@@ -140,8 +149,6 @@ void Manager::load()
 	m_subscriptions.append(customList);
 
 			foreach (Subscription* subscription, m_subscriptions) {
-			subscription->loadSubscription(m_disabledRules);
-
 			connect(subscription,
 					&Subscription::subscriptionUpdated,
 					Application::instance(),
@@ -152,7 +159,14 @@ void Manager::load()
 	if (lastUpdate.addDays(5) < QDateTime::currentDateTime())
 		QTimer::singleShot(1000 * 60, this, &Manager::updateAllSubscriptions);
 
-	m_matcher->update();
+	if (!FilterCache::load(this, m_matcher)) {
+		foreach (Subscription* subscription, m_subscriptions)
+			subscription->loadSubscription(m_disabledRules);
+
+		m_saveCacheOnUpdate = true;
+		m_matcher->update();
+	}
+
 	m_loaded = true;
 
 	Application::instance()->networkManager()->installUrlInterceptor(m_interceptor);
@@ -174,6 +188,9 @@ void Manager::save()
 	settings.setValue("disabledRules", m_disabledRules);
 
 	settings.endGroup();
+
+	if (!m_matcher->isUpdating())
+		FilterCache::save(this, m_matcher);
 }
 
 bool Manager::isEnabled() const
@@ -181,7 +198,7 @@ bool Manager::isEnabled() const
 	return m_enabled;
 }
 
-bool Manager::canRunOnScheme(const QString& scheme) const
+bool Manager::canRunOnScheme(const QString& scheme)
 {
 	return !(scheme == QLatin1String("file") || scheme == QLatin1String("qrc") || scheme == QLatin1String("sielo")
 			 || scheme == QLatin1String("data") || scheme == QLatin1String("adb"));
@@ -218,6 +235,16 @@ QString Manager::elementHidingRulesForDomain(const QUrl& url) const
 	return m_matcher->elementHidingRulesForDomain(url.host());
 }
 
+bool Manager::elementHidingEnabled(const QUrl& url) const
+{
+	return isEnabled() && canRunOnScheme(url.scheme()) && canBeBlocked(url);
+}
+
+QString Manager::elementHidingId()
+{
+	return QStringLiteral("_sielo_element_hiding");
+}
+
 Subscription* Manager::subscriptionByName(const QString& name) const
 {
 			foreach (Subscription* subscription, m_subscriptions) {
@@ -320,22 +347,26 @@ bool Manager::removeSubscription(Subscription* subscription)
 	m_subscriptions.removeOne(subscription);
 
 	m_matcher->update();
-	delete subscription;
+
+	// Rules of the current matcher snapshot may still point to it from the IO thread
+	m_removedSubscriptions.append(subscription);
 
 	return true;
 }
 
 bool Manager::block(Engine::UrlRequestInfo& request)
 {
-	const QString urlString{request.requestUrl().toEncoded().toLower()};
-	const QString urlDomain{request.requestUrl().host().toLower()};
-	const QString urlScheme{request.requestUrl().scheme().toLower()};
+	if (!isEnabled())
+		return false;
 
-	if (!isEnabled() || !canRunOnScheme(urlScheme))
+	RequestContext& context{RequestContext::local()};
+	context.reset(request);
+
+	if (!canRunOnScheme(context.scheme()))
 		return false;
 
 	bool res{false};
-	const Rule* blockedRule{m_matcher->match(request, urlDomain, urlString)};
+	const Rule* blockedRule{m_matcher->match(context)};
 
 	if (blockedRule) {
 		res = true;
@@ -426,6 +457,34 @@ Dialog* Manager::showDialog()
 	return nullptr;
 }
 
+void Manager::matcherUpdated()
+{
+	if (!m_saveCacheOnUpdate)
+		return;
+
+	m_saveCacheOnUpdate = false;
+	FilterCache::save(this, m_matcher);
+}
+
+void Manager::updateElementHidingScript()
+{
+	Engine::WebProfile* profile{Application::instance()->webProfile()};
+	const QString rules{isEnabled() ? m_matcher->elementHidingRules() : QString()};
+
+	if (!profile || rules == m_elementHidingRules)
+		return;
+
+	m_elementHidingRules = rules;
+
+	// The generic rules are the same for every page, they are compiled once in a profile script
+	// instead of being sent to each page after it loaded
+	profile->removeScript(elementHidingId());
+
+	if (!m_elementHidingRules.isEmpty())
+		profile->insertScript(elementHidingId(), Scripts::elementHiding(m_elementHidingRules, elementHidingId()),
+							  Engine::WebProfile::DocumentCreation, Engine::WebProfile::ApplicationWorld, true);
+}
+
 bool Manager::canBeBlocked(const QUrl& url) const
 {
 	return !m_matcher->adBlockDisabledForUrl(url);
@@ -61,13 +61,16 @@ public:
 	void save();
 
 	bool isEnabled() const;
-	bool canRunOnScheme(const QString& scheme) const;
+	static bool canRunOnScheme(const QString& scheme);
 
 	bool useLimitedEasyList() const;
 	void setUseLimitedEasyList(bool useLimited);
 
 	QString elementHidingRules(const QUrl& url) const;
 	QString elementHidingRulesForDomain(const QUrl& url) const;
+	bool elementHidingEnabled(const QUrl& url) const;
+
+	static QString elementHidingId();
 
 	Subscription* subscriptionByName(const QString& name) const;
 	QList<Subscription*> subscriptions() const;
@@ -85,6 +88,7 @@ public:
 	void removeDisabledRule(const QString& filter);
 
 	CustomList* customList() const;
+	Matcher* matcher() const { return m_matcher; }
 
 	static Manager* instance();
 
@@ -99,19 +103,26 @@ public slots:
 
 	Dialog* showDialog();
 
+private slots:
+	void matcherUpdated();
+	void updateElementHidingScript();
+
 private:
 	inline bool canBeBlocked(const QUrl& url) const;
 
 	bool m_loaded{false};
 	bool m_enabled{false};
 	bool m_useLimitedEasyList{true};
+	bool m_saveCacheOnUpdate{false};
 
 	QList<Subscription*> m_subscriptions;
+	QList<Subscription*> m_removedSubscriptions;
 	QPointer<Dialog> m_adBlockDialog;
 	Matcher* m_matcher{nullptr};
 	UrlInterceptor* m_interceptor{nullptr};
 
 	QStringList m_disabledRules;
+	QString m_elementHidingRules{};
 };
 
 }
@@ -24,54 +24,83 @@
 
 #include "AdBlock/Matcher.hpp"
 
+#include <algorithm>
 
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "AdBlock/FilterCache.hpp"
 #include "AdBlock/Manager.hpp"
+#include "AdBlock/RequestContext.hpp"
 #include "AdBlock/Subscription.hpp"
 #include "AdBlock/Rule.hpp"
 
 namespace Sn {
 namespace ADB {
 
+Matcher::Data::~Data()
+{
+	qDeleteAll(createdRules);
+}
+
 Matcher::Matcher(Manager* manager) :
 		QObject(manager),
-		m_manager(manager)
+		m_manager(manager),
+		m_watcher(new QFutureWatcher<DataPtr>(this))
 {
 	connect(manager, &Manager::enabledChanged, this, &Matcher::enabledChanged);
+	connect(m_watcher, &QFutureWatcher<DataPtr>::finished, this, &Matcher::buildFinished);
+}
+
+Matcher::Matcher(const QList<Subscription*>& subscriptions, QObject* parent) :
+		QObject(parent),
+		m_subscriptions(subscriptions),
+		m_watcher(new QFutureWatcher<DataPtr>(this))
+{
+	connect(m_watcher, &QFutureWatcher<DataPtr>::finished, this, &Matcher::buildFinished);
 }
 
 Matcher::~Matcher()
 {
+	m_watcher->waitForFinished();
 	clear();
 }
 
-const Rule* Matcher::match(const Engine::UrlRequestInfo& request, const QString& urlDomain,
-						   const QString& urlString) const
+const Rule* Matcher::match(const RequestContext& context) const
 {
-	if (m_networkExceptionTree.find(request, urlDomain, urlString))
+	const DataPtr snapshot{data()};
+
+	if (!snapshot)
 		return nullptr;
 
-			foreach (const Rule* rule, m_networkExceptionRules) {
-			if (rule->networkMatch(request, urlDomain, urlString))
-				return nullptr;
-		}
+	if (snapshot->networkExceptionTree.find(context))
+		return nullptr;
+
+	TokenIndex::Tokens urlTokens{};
+	TokenIndex::tokenize(context.urlString(), urlTokens);
+
+	if (snapshot->networkExceptionIndex.find(context, urlTokens))
+		return nullptr;
 
-	if (const Rule* rule = m_networkBlockTree.find(request, urlDomain, urlString))
+	if (const Rule* rule = snapshot->networkBlockTree.find(context))
 		return rule;
 
-			foreach (const Rule* rule, m_networkBlockRules) {
-			if (rule->networkMatch(request, urlDomain, urlString))
-				return rule;
-		}
+	if (const Rule* rule = snapshot->networkBlockIndex.find(context, urlTokens))
+		return rule;
 
 	return nullptr;
 }
 
 bool Matcher::adBlockDisabledForUrl(const QUrl& url) const
 {
-	int count{m_documentRules.count()};
+	const DataPtr snapshot{data()};
+
+	if (!snapshot)
+		return false;
+
+	int count{snapshot->documentRules.count()};
 
 	for (int i{0}; i < count; ++i)
-		if (m_documentRules[i]->urlMatch(url))
+		if (snapshot->documentRules[i]->urlMatch(url))
 			return true;
 
 	return false;
@@ -82,10 +111,15 @@ bool Matcher::elementHideDisabledForUrl(const QUrl& url) const
 	if (adBlockDisabledForUrl(url))
 		return true;
 
-	int count{m_elementHideRules.count()};
+	const DataPtr snapshot{data()};
+
+	if (!snapshot)
+		return false;
+
+	int count{snapshot->elementHideRules.count()};
 
 	for (int i{0}; i < count; ++i)
-		if (m_elementHideRules[i]->urlMatch(url))
+		if (snapshot->elementHideRules[i]->urlMatch(url))
 			return true;
 
 	return false;
@@ -93,15 +127,52 @@ bool Matcher::elementHideDisabledForUrl(const QUrl& url) const
 
 QString Matcher::elementHidingRules() const
 {
-	return m_elementHidingRules;
+	const DataPtr snapshot{data()};
+
+	return snapshot ? snapshot->elementHidingRules : QString();
 }
 
 QString Matcher::elementHidingRulesForDomain(const QString& domain) const
 {
+	const DataPtr snapshot{data()};
+
+	if (!snapshot)
+		return QString();
+
+	{
+		QMutexLocker locker{&snapshot->domainCssMutex};
+
+		if (const QString* cachedRules = snapshot->domainCssCache.object(domain))
+			return *cachedRules;
+	}
+
+	QVector<int> candidates{snapshot->unrestrictedDomainCssRules};
+	QString suffix{domain};
+
+	forever {
+		auto it = snapshot->domainCssIndex.constFind(suffix);
+
+		if (it != snapshot->domainCssIndex.constEnd())
+			candidates.append(it.value());
+
+		const int dotIndex{suffix.indexOf(QLatin1Char('.'))};
+
+		if (dotIndex < 0)
+			break;
+
+		suffix = suffix.mid(dotIndex + 1);
+	}
+
+	// Keep the rules in the same order as the full scan did
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
 	QString rules{};
 	int addedRulesCount{0};
 
-			foreach(const Rule* rule, m_domainRestrictedCssRules) {
+			foreach(int index, candidates) {
+			const Rule* rule{snapshot->domainRestrictedCssRules[index]};
+
 			if (!rule->matchDomain(domain))
 				continue;
 
@@ -122,19 +193,195 @@ QString Matcher::elementHidingRulesForDomain(const QString& domain) const
 		rules.append(QLatin1String("{display:none !important;}\n"));
 	}
 
+	QMutexLocker locker{&snapshot->domainCssMutex};
+	snapshot->domainCssCache.insert(domain, new QString(rules));
+
 	return rules;
+}
+
+bool Matcher::isUpdating() const
+{
+	return m_watcher->isRunning() || m_updatePending;
+}
+
+void Matcher::saveState(QDataStream& stream, QHash<const Rule*, qint32> ruleIds) const
+{
+	const DataPtr snapshot{data()};
+	const Data empty{};
+	const Data& state{snapshot ? *snapshot : empty};
+
+	const QList<Subscription*> subscriptions{this->subscriptions()};
+
+	stream << static_cast<qint32>(state.createdRules.count());
+
+	for (const Rule* rule : state.createdRules) {
+		ruleIds.insert(rule, ruleIds.count());
+
+		stream << static_cast<qint32>(subscriptions.indexOf(rule->subscriptions()));
+		stream << *rule;
+	}
+
+	FilterCache::writeRuleIds(stream, state.domainRestrictedCssRules, ruleIds);
+	FilterCache::writeRuleIds(stream, state.documentRules, ruleIds);
+	FilterCache::writeRuleIds(stream, state.elementHideRules, ruleIds);
+
+	stream << state.elementHidingRules;
+
+	state.networkBlockTree.save(stream, ruleIds);
+	state.networkExceptionTree.save(stream, ruleIds);
+	state.networkBlockIndex.save(stream, ruleIds);
+	state.networkExceptionIndex.save(stream, ruleIds);
+}
+
+bool Matcher::loadState(QDataStream& stream, QVector<const Rule*> rules)
+{
+	std::shared_ptr<Data> state{std::make_shared<Data>()};
+
+	foreach (const Source& source, sources())
+		state->storages.append(source.storage);
+
+	const QList<Subscription*> subscriptions{this->subscriptions()};
+	qint32 createdRulesCount{0};
+
+	stream >> createdRulesCount;
+
+	if (createdRulesCount < 0 || stream.status() != QDataStream::Ok)
+		return false;
+
+	for (qint32 i{0}; i < createdRulesCount; ++i) {
+		qint32 subscriptionIndex{-1};
+		stream >> subscriptionIndex;
+
+		Rule* rule{new Rule(QString(), subscriptions.value(subscriptionIndex, nullptr))};
+		stream >> *rule;
+
+		state->createdRules.append(rule);
+		rules.append(rule);
+	}
+
+	bool loaded{stream.status() == QDataStream::Ok
+				&& FilterCache::readRuleIds(stream, state->domainRestrictedCssRules, rules)
+				&& FilterCache::readRuleIds(stream, state->documentRules, rules)
+				&& FilterCache::readRuleIds(stream, state->elementHideRules, rules)};
+
+	if (loaded) {
+		stream >> state->elementHidingRules;
+
+		loaded = stream.status() == QDataStream::Ok
+				 && state->networkBlockTree.load(stream, rules)
+				 && state->networkExceptionTree.load(stream, rules)
+				 && state->networkBlockIndex.load(stream, rules)
+				 && state->networkExceptionIndex.load(stream, rules);
+	}
+
+	if (!loaded)
+		return false;
+
+	indexDomainCssRules(*state);
 
+	++m_generation;
+	m_updatePending = false;
+
+	publish(state);
+	emit updated();
+
+	return true;
 }
 
 void Matcher::update()
 {
-	clear();
+	++m_generation;
+
+	if (m_watcher->isRunning()) {
+		m_updatePending = true;
+		return;
+	}
+
+	startBuild();
+}
+
+void Matcher::clear()
+{
+	++m_generation;
+	m_updatePending = false;
+
+	publish(DataPtr());
+}
+
+void Matcher::enabledChanged(bool enabled)
+{
+	if (enabled)
+		update();
+	else
+		clear();
+}
+
+void Matcher::buildFinished()
+{
+	if (m_updatePending) {
+		m_updatePending = false;
+		startBuild();
+
+		return;
+	}
+
+	if (m_buildGeneration != m_generation)
+		return;
+
+	publish(m_watcher->result());
+	emit updated();
+}
+
+Matcher::DataPtr Matcher::data() const
+{
+	return std::atomic_load(&m_data);
+}
+
+void Matcher::publish(const DataPtr& data)
+{
+	std::atomic_store(&m_data, data);
+}
+
+void Matcher::startBuild()
+{
+	const QVector<Source> currentSources{sources()};
+
+	m_buildGeneration = m_generation;
+	m_watcher->setFuture(QtConcurrent::run([currentSources]() { return build(currentSources); }));
+}
+
+QList<Subscription*> Matcher::subscriptions() const
+{
+	return m_manager ? m_manager->subscriptions() : m_subscriptions;
+}
+
+QVector<Matcher::Source> Matcher::sources() const
+{
+	QVector<Source> sources{};
+
+	foreach (Subscription* subscription, subscriptions()) {
+		Source source{};
+
+		source.storage = subscription->ruleStorage();
+		source.rules = subscription->allRulles();
+
+		sources.append(source);
+	}
+
+	return sources;
+}
+
+Matcher::DataPtr Matcher::build(const QVector<Source>& sources)
+{
+	std::shared_ptr<Data> data{std::make_shared<Data>()};
 
 	QHash<QString, const Rule*> CSSRulesHash;
 	QVector<const Rule*> exceptionCSSRules;
 
-			foreach (Subscription* subscription, m_manager->subscriptions()) {
-					foreach (const Rule* rule, subscription->allRulles()) {
+			foreach (const Source& source, sources) {
+			data->storages.append(source.storage);
+
+					foreach (const Rule* rule, source.rules) {
 					if (rule->isInternalDisabled())
 						continue;
 
@@ -148,20 +395,25 @@ void Matcher::update()
 							CSSRulesHash.insert(rule->CSSSelector(), rule);
 					}
 					else if (rule->isDocument())
-						m_documentRules.append(rule);
+						data->documentRules.append(rule);
 					else if (rule->isElementHide())
-						m_elementHideRules.append(rule);
+						data->elementHideRules.append(rule);
 					else if (rule->isException()) {
-						if (!m_networkExceptionTree.add(rule))
-							m_networkExceptionRules.append(rule);
+						if (!data->networkExceptionTree.add(rule))
+							data->networkExceptionIndex.add(rule);
 					}
 					else {
-						if (!m_networkBlockTree.add(rule))
-							m_networkBlockRules.append(rule);
+						if (!data->networkBlockTree.add(rule))
+							data->networkBlockIndex.add(rule);
 					}
 				}
 		}
 
+	data->networkExceptionTree.build();
+	data->networkBlockTree.build();
+	data->networkExceptionIndex.build();
+	data->networkBlockIndex.build();
+
 			foreach (const Rule* rule, exceptionCSSRules) {
 			const Rule* originalRule{CSSRulesHash.value(rule->CSSSelector())};
 
@@ -175,7 +427,7 @@ void Matcher::update()
 
 			CSSRulesHash[rule->CSSSelector()] = copiedRule;
 
-			m_createdRules.append(copiedRule);
+			data->createdRules.append(copiedRule);
 		}
 
 	int hidingRulesCount{0};
@@ -188,48 +440,47 @@ void Matcher::update()
 		const Rule* rule{it.value()};
 
 		if (rule->isDomainRestricted())
-			m_domainRestrictedCssRules.append(rule);
+			data->domainRestrictedCssRules.append(rule);
 		else if (Q_UNLIKELY(hidingRulesCount == 1000)) {
-			m_elementHidingRules.append(rule->CSSSelector());
-			m_elementHidingRules.append(QLatin1String("{display:none !important;} "));
+			data->elementHidingRules.append(rule->CSSSelector());
+			data->elementHidingRules.append(QLatin1String("{display:none !important;} "));
 
 			hidingRulesCount = 0;
 		}
 		else {
-			m_elementHidingRules.append(rule->CSSSelector() + QLatin1Char(','));
+			data->elementHidingRules.append(rule->CSSSelector() + QLatin1Char(','));
 
 			++hidingRulesCount;
 		}
 	}
 
 	if (hidingRulesCount != 0) {
-		m_elementHidingRules = m_elementHidingRules.left(m_elementHidingRules.size() - 1);
-		m_elementHidingRules.append(QLatin1String("{display:none !important;} "));
+		data->elementHidingRules = data->elementHidingRules.left(data->elementHidingRules.size() - 1);
+		data->elementHidingRules.append(QLatin1String("{display:none !important;} "));
 	}
-}
 
-void Matcher::clear()
-{
-	qDeleteAll(m_createdRules);
-	m_createdRules.clear();
-	m_networkExceptionRules.clear();
-	m_networkBlockRules.clear();
-	m_domainRestrictedCssRules.clear();
-	m_documentRules.clear();
-	m_elementHideRules.clear();
+	indexDomainCssRules(*data);
 
-	m_elementHidingRules.clear();
-	m_networkBlockTree.clear();
-	m_networkExceptionTree.clear();
+	return data;
 }
 
-void Matcher::enabledChanged(bool enabled)
+void Matcher::indexDomainCssRules(Data& data)
 {
-	if (enabled)
-		update();
-	else
-		clear();
+	data.domainCssIndex.clear();
+	data.unrestrictedDomainCssRules.clear();
+
+	for (int i{0}; i < data.domainRestrictedCssRules.count(); ++i) {
+		const Rule* rule{data.domainRestrictedCssRules[i]};
+
+		if (rule->m_allowedDomains.isEmpty()) {
+			data.unrestrictedDomainCssRules.append(i);
+			continue;
+		}
+
+		foreach (const QString& domain, rule->m_allowedDomains)
+			data.domainCssIndex[domain].append(i);
+	}
 }
 
 }
-}
\ No newline at end of file
+}
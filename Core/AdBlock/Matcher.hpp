@@ -28,8 +28,16 @@
 
 #include "SharedDefines.hpp"
 
+#include <memory>
+
 #include <QObject>
 
+#include <QCache>
+#include <QDataStream>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QMutex>
+
 #include <QVector>
 
 #include <QUrl>
@@ -37,22 +45,32 @@
 #include <QWebEngine/UrlRequestInfo.hpp>
 
 #include "AdBlock/SearchTree.hpp"
+#include "AdBlock/Subscription.hpp"
+#include "AdBlock/TokenIndex.hpp"
 
 namespace Sn {
 namespace ADB {
 class Manager;
 
+class RequestContext;
+
 class Rule;
 
+/*
+ * The compiled rules are an immutable snapshot built on a worker thread and
+ * published with an atomic pointer swap, so the interceptor running on the
+ * WebEngine IO thread never waits for a rebuild nor sees a half-built matcher.
+ */
 class SIELO_SHAREDLIB Matcher : public QObject {
 Q_OBJECT
 
 public:
 	Matcher(Manager* manager);
+	// Matches against a fixed set of subscriptions, without a manager nor a profile
+	Matcher(const QList<Subscription*>& subscriptions, QObject* parent = nullptr);
 	~Matcher();
 
-	const Rule* match(const Engine::UrlRequestInfo& request, const QString& urlDomain,
-					  const QString& urlString) const;
+	const Rule* match(const RequestContext& context) const;
 
 	bool adBlockDisabledForUrl(const QUrl& url) const;
 	bool elementHideDisabledForUrl(const QUrl& url) const;
@@ -60,26 +78,72 @@ public:
 	QString elementHidingRules() const;
 	QString elementHidingRulesForDomain(const QString& domain) const;
 
+	bool isUpdating() const;
+
+	void saveState(QDataStream& stream, QHash<const Rule*, qint32> ruleIds) const;
+	bool loadState(QDataStream& stream, QVector<const Rule*> rules);
+
+signals:
+	void updated();
+
 public slots:
 	void update();
 	void clear();
 
 private slots:
 	void enabledChanged(bool enabled);
+	void buildFinished();
 
 private:
+	struct Source {
+		std::shared_ptr<Subscription::RuleStorage> storage{};
+		QVector<Rule*> rules{};
+	};
+
+	struct Data {
+		~Data();
+
+		QVector<std::shared_ptr<Subscription::RuleStorage>> storages{};
+
+		QVector<Rule*> createdRules;
+		QVector<const Rule*> domainRestrictedCssRules;
+		QVector<const Rule*> documentRules;
+		QVector<const Rule*> elementHideRules;
+
+		// Domain → indexes in domainRestrictedCssRules, rules with only excluded domains apply everywhere
+		QHash<QString, QVector<int>> domainCssIndex{};
+		QVector<int> unrestrictedDomainCssRules{};
+
+		mutable QMutex domainCssMutex{};
+		mutable QCache<QString, QString> domainCssCache{64};
+
+		QString elementHidingRules{};
+		SearchTree networkBlockTree{};
+		SearchTree networkExceptionTree{};
+		TokenIndex networkBlockIndex{};
+		TokenIndex networkExceptionIndex{};
+	};
+
+	using DataPtr = std::shared_ptr<const Data>;
+
+	DataPtr data() const;
+	void publish(const DataPtr& data);
+	void startBuild();
+
+	QList<Subscription*> subscriptions() const;
+	QVector<Source> sources() const;
+	static DataPtr build(const QVector<Source>& sources);
+	static void indexDomainCssRules(Data& data);
+
 	Manager* m_manager{nullptr};
+	QList<Subscription*> m_subscriptions{};
 
-	QVector<Rule*> m_createdRules;
-	QVector<const Rule*> m_networkExceptionRules;
-	QVector<const Rule*> m_networkBlockRules;
-	QVector<const Rule*> m_domainRestrictedCssRules;
-	QVector<const Rule*> m_documentRules;
-	QVector<const Rule*> m_elementHideRules;
+	DataPtr m_data{};
 
-	QString m_elementHidingRules{};
-	SearchTree m_networkBlockTree{};
-	SearchTree m_networkExceptionTree{};
+	QFutureWatcher<DataPtr>* m_watcher{nullptr};
+	quint64 m_generation{0};
+	quint64 m_buildGeneration{0};
+	bool m_updatePending{false};
 };
 
 }
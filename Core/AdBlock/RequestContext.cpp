@@ -0,0 +1,123 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "AdBlock/RequestContext.hpp"
+
+namespace Sn {
+namespace ADB {
+
+static const int MAX_CACHED_DOMAINS = 512;
+
+// resize() keeps the capacity, so the buffers are only reallocated when they grow
+static void assignLower(QString& target, const QByteArray& source)
+{
+	const int length{source.size()};
+	const char* string{source.constData()};
+
+	target.resize(length);
+
+	QChar* data{target.data()};
+
+	for (int i{0}; i < length; ++i)
+		data[i] = QChar(QLatin1Char(string[i])).toLower();
+}
+
+static void assignLower(QString& target, const QString& source)
+{
+	const int length{source.size()};
+	const QChar* string{source.constData()};
+
+	target.resize(length);
+
+	QChar* data{target.data()};
+
+	for (int i{0}; i < length; ++i)
+		data[i] = string[i].toLower();
+}
+
+static QString toSecondLevelDomain(const QString& urlHost, const QUrl& url)
+{
+	if (urlHost.isEmpty())
+		return QString();
+
+	const QString topLevelDomain{url.topLevelDomain()};
+
+	if (topLevelDomain.isEmpty())
+		return QString();
+
+	QString domain{urlHost.left(urlHost.size() - topLevelDomain.size())};
+
+	if (domain.count(QLatin1Char('.')) != 0)
+		return urlHost;
+
+	while (domain.count(QLatin1Char('.')) != 0)
+		domain = domain.mid(domain.indexOf(QLatin1Char('.')) + 1);
+
+	return domain + topLevelDomain;
+}
+
+void RequestContext::reset(const Engine::UrlRequestInfo& request)
+{
+	m_request = &request;
+	m_requestUrl = request.requestUrl();
+	m_firstPartyUrl = request.firstPartyUrl();
+
+	// QUrl has no accessor without a temporary for the encoded url and the hosts, each host is
+	// read once and reused for the registrable domain lookups
+	const QString host{m_requestUrl.host()};
+
+	assignLower(m_urlString, m_requestUrl.toEncoded());
+	assignLower(m_domain, host);
+	assignLower(m_scheme, m_requestUrl.scheme());
+
+	m_firstPartyHost = m_firstPartyUrl.host();
+	m_isThirdParty = registrableDomain(m_firstPartyHost, m_firstPartyUrl) != registrableDomain(host, m_requestUrl);
+}
+
+RequestContext& RequestContext::local()
+{
+	static thread_local RequestContext context{};
+
+	return context;
+}
+
+QString RequestContext::registrableDomain(const QString& host, const QUrl& url)
+{
+	// Avoid looking up the public suffix list again for hosts we've already seen
+	auto it = m_registrableDomains.constFind(host);
+
+	if (it != m_registrableDomains.constEnd())
+		return it.value();
+
+	if (m_registrableDomains.size() >= MAX_CACHED_DOMAINS)
+		m_registrableDomains.clear();
+
+	const QString domain{toSecondLevelDomain(host, url)};
+	m_registrableDomains.insert(host, domain);
+
+	return domain;
+}
+
+}
+}
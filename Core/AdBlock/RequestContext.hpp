@@ -0,0 +1,82 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_ADBREQUESTCONTEXT_HPP
+#define SIELOBROWSER_ADBREQUESTCONTEXT_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QHash>
+#include <QString>
+#include <QUrl>
+
+#include <QWebEngine/UrlRequestInfo.hpp>
+
+namespace Sn {
+namespace ADB {
+
+/*
+ * Everything the rules need to know about a request, computed once per request.
+ * One instance lives per thread and the lower case url, domain and scheme are
+ * written into reused buffers. QUrl still allocates the encoded url and both
+ * hosts, so a request costs three temporaries.
+ */
+class SIELO_SHAREDLIB RequestContext {
+public:
+	void reset(const Engine::UrlRequestInfo& request);
+
+	const Engine::UrlRequestInfo& request() const { return *m_request; }
+
+	const QString& urlString() const { return m_urlString; }
+	const QString& domain() const { return m_domain; }
+	const QString& scheme() const { return m_scheme; }
+	const QString& firstPartyHost() const { return m_firstPartyHost; }
+
+	bool isThirdParty() const { return m_isThirdParty; }
+
+	static RequestContext& local();
+
+private:
+	QString registrableDomain(const QString& host, const QUrl& url);
+
+	const Engine::UrlRequestInfo* m_request{nullptr};
+
+	QUrl m_requestUrl{};
+	QUrl m_firstPartyUrl{};
+
+	QString m_urlString{};
+	QString m_domain{};
+	QString m_scheme{};
+	QString m_firstPartyHost{};
+
+	bool m_isThirdParty{false};
+
+	QHash<QString, QString> m_registrableDomains{};
+};
+
+}
+}
+
+#endif //SIELOBROWSER_ADBREQUESTCONTEXT_HPP
@@ -26,31 +26,13 @@
 
 #include <QList>
 
+#include "AdBlock/RequestContext.hpp"
 #include "AdBlock/SearchTree.hpp"
 #include "AdBlock/Subscription.hpp"
 
 namespace Sn {
 namespace ADB {
 
-static QString toSecondLevelDomain(const QUrl& url)
-{
-	const QString topLevelDomain{url.topLevelDomain()};
-	const QString urlHost{url.host()};
-
-	if (topLevelDomain.isEmpty() || url.host().isEmpty())
-		return QString();
-
-	QString domain{urlHost.left(urlHost.size() - topLevelDomain.size())};
-
-	if (domain.count(QLatin1Char('.')) != 0)
-		return urlHost;
-
-	while (domain.count(QLatin1Char('.')) != 0)
-		domain = domain.mid(domain.indexOf(QLatin1Char('.')) + 1);
-
-	return domain + topLevelDomain;
-}
-
 Rule::Rule(const QString& filter, Subscription* subscription) :
 		m_subscription(subscription),
 		m_type(StringContainsMatchRule),
@@ -86,13 +68,75 @@ Rule* Rule::copy() const
 
 	if (m_regExp) {
 		rule->m_regExp = new ADBRegExp;
-		rule->m_regExp->regExp = m_regExp->regExp;
-		rule->m_regExp->matchers = m_regExp->matchers;
+		rule->m_regExp->pattern = m_regExp->pattern;
+		rule->m_regExp->strings = m_regExp->strings;
 	}
 
 	return rule;
 }
 
+QDataStream& operator<<(QDataStream& stream, const Rule& rule)
+{
+	stream << static_cast<qint32>(rule.m_type);
+	stream << static_cast<qint32>(rule.m_options);
+	stream << static_cast<qint32>(rule.m_exceptions);
+	stream << rule.m_filter;
+	stream << rule.m_matchString;
+	stream << static_cast<qint32>(rule.m_caseSensitivity);
+	stream << rule.m_allowedDomains;
+	stream << rule.m_blockedDomains;
+	stream << rule.m_isEnabled;
+	stream << rule.m_isException;
+	stream << rule.m_isInternalDisabled;
+	stream << (rule.m_regExp != nullptr);
+
+	if (rule.m_regExp) {
+		stream << rule.m_regExp->pattern;
+		stream << rule.m_regExp->strings;
+	}
+
+	return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, Rule& rule)
+{
+	qint32 type{0};
+	qint32 options{0};
+	qint32 exceptions{0};
+	qint32 caseSensitivity{0};
+	bool hasRegExp{false};
+
+	stream >> type;
+	stream >> options;
+	stream >> exceptions;
+	stream >> rule.m_filter;
+	stream >> rule.m_matchString;
+	stream >> caseSensitivity;
+	stream >> rule.m_allowedDomains;
+	stream >> rule.m_blockedDomains;
+	stream >> rule.m_isEnabled;
+	stream >> rule.m_isException;
+	stream >> rule.m_isInternalDisabled;
+	stream >> hasRegExp;
+
+	rule.m_type = static_cast<Rule::RuleType>(type);
+	rule.m_options = Rule::RuleOptions(options);
+	rule.m_exceptions = Rule::RuleOptions(exceptions);
+	rule.m_caseSensitivity = static_cast<Qt::CaseSensitivity>(caseSensitivity);
+
+	delete rule.m_regExp;
+	rule.m_regExp = nullptr;
+
+	if (hasRegExp) {
+		rule.m_regExp = new Rule::ADBRegExp;
+
+		stream >> rule.m_regExp->pattern;
+		stream >> rule.m_regExp->strings;
+	}
+
+	return stream;
+}
+
 void Rule::setSubscription(Subscription* subscription)
 {
 	m_subscription = subscription;
@@ -170,18 +214,19 @@ bool Rule::urlMatch(const QUrl& url) const
 	return stringMatch(domain, encodedUrl);
 }
 
-bool Rule::networkMatch(const Engine::UrlRequestInfo& request, const QString& domain,
-						const QString& encodedUrl) const
+bool Rule::networkMatch(const RequestContext& context) const
 {
 	if (m_type == CSSRule || !m_isEnabled || m_isInternalDisabled)
 		return false;
 
-	bool matched{stringMatch(domain, encodedUrl)};
+	bool matched{stringMatch(context.domain(), context.urlString())};
 
 	if (matched) {
-		if (hasOption(DomainRestrictedOption) && !matchDomain(request.firstPartyUrl().host()))
+		const Engine::UrlRequestInfo& request{context.request()};
+
+		if (hasOption(DomainRestrictedOption) && !matchDomain(context.firstPartyHost()))
 			return false;
-		if (hasOption(ThirdPartyOption) && !matchThirdParty(request))
+		if (hasOption(ThirdPartyOption) && !matchThirdParty(context))
 			return false;
 		if (hasOption(ObjectOption) && !matchObject(request))
 			return false;
@@ -249,12 +294,9 @@ bool Rule::matchDomain(const QString& domain) const
 	return false;
 }
 
-bool Rule::matchThirdParty(const Engine::UrlRequestInfo& request) const
+bool Rule::matchThirdParty(const RequestContext& context) const
 {
-	const QString firstPartyHost{toSecondLevelDomain(request.firstPartyUrl())};
-	const QString host{toSecondLevelDomain(request.requestUrl())};
-
-	bool match{firstPartyHost != host};
+	bool match{context.isThirdParty()};
 
 	return hasException(ThirdPartyOption) == !match;
 }
@@ -350,7 +392,7 @@ bool Rule::stringMatch(const QString& domain, const QString& encodedUrl) const
 		if (!isMatchingRegExpString(encodedUrl))
 			return false;
 
-		return (m_regExp->regExp.indexIn(encodedUrl) != -1);
+		return (compiledRegExp().regExp.indexIn(encodedUrl) != -1);
 	}
 
 	return false;
@@ -373,7 +415,7 @@ bool Rule::isMatchingRegExpString(const QString& url) const
 {
 	Q_ASSERT(m_regExp);
 
-			foreach (const QStringMatcher& matcher, m_regExp->matchers) {
+			foreach (const QStringMatcher& matcher, compiledRegExp().matchers) {
 			if (matcher.indexIn(url) == -1)
 				return false;
 		}
@@ -550,8 +592,8 @@ void Rule::parseFilter()
 		m_type = RegExpMatchRule;
 
 		m_regExp = new ADBRegExp;
-		m_regExp->regExp = RegExp(parsedLine, m_caseSensitivity);
-		m_regExp->matchers = createStringMatchers(parseRegExpFilter(parsedLine));
+		m_regExp->pattern = parsedLine;
+		m_regExp->strings = parseRegExpFilter(parsedLine);
 
 		return;
 	}
@@ -585,8 +627,8 @@ void Rule::parseFilter()
 		|| parsedLine.contains(QLatin1Char('|'))) {
 		m_type = RegExpMatchRule;
 		m_regExp = new ADBRegExp;
-		m_regExp->regExp = RegExp(createRegExpFromFilter(parsedLine), m_caseSensitivity);
-		m_regExp->matchers = createStringMatchers(parseRegExpFilter(parsedLine));
+		m_regExp->pattern = createRegExpFromFilter(parsedLine);
+		m_regExp->strings = parseRegExpFilter(parsedLine);
 
 		return;
 	}
@@ -696,6 +738,19 @@ QString Rule::createRegExpFromFilter(const QString& filter) const
 	return parsed;
 }
 
+const Rule::ADBRegExp& Rule::compiledRegExp() const
+{
+	Q_ASSERT(m_regExp);
+
+	// Rules are shared by the threads matching requests
+	std::call_once(m_regExp->compiled, [this]() {
+		m_regExp->regExp = RegExp(m_regExp->pattern, m_caseSensitivity);
+		m_regExp->matchers = createStringMatchers(m_regExp->strings);
+	});
+
+	return *m_regExp;
+}
+
 QList<QStringMatcher> Rule::createStringMatchers(const QStringList& filters) const
 {
 	QList<QStringMatcher> matchers;
@@ -28,8 +28,12 @@
 
 #include "SharedDefines.hpp"
 
+#include <mutex>
+
 #include <QObject>
 
+#include <QDataStream>
+
 #include <QStringList>
 #include <QStringMatcher>
 
@@ -49,6 +53,10 @@ class Matcher;
 
 class SearchTree;
 
+class TokenIndex;
+
+class RequestContext;
+
 class SIELO_SHAREDLIB Rule {
 	Q_DISABLE_COPY(Rule);
 
@@ -83,10 +91,10 @@ public:
 	bool isInternalDisabled() const;
 
 	bool urlMatch(const QUrl& url) const;
-	bool networkMatch(const Engine::UrlRequestInfo& request, const QString& domain, const QString& encodedUrl) const;
+	bool networkMatch(const RequestContext& context) const;
 
 	bool matchDomain(const QString& domain) const;
-	bool matchThirdParty(const Engine::UrlRequestInfo& request) const;
+	bool matchThirdParty(const RequestContext& context) const;
 	bool matchObject(const Engine::UrlRequestInfo& request) const;
 	bool matchSubdocument(const Engine::UrlRequestInfo& request) const;
 	bool matchXMLHttpRequest(const Engine::UrlRequestInfo& request) const;
@@ -150,12 +158,19 @@ private:
 
 	Subscription* m_subscription{nullptr};
 
+	// Only the sources are kept when parsing or loading from the filter cache, the
+	// expression and the matchers are built the first time the rule is matched
 	struct ADBRegExp {
-		RegExp regExp;
-		QList<QStringMatcher> matchers;
+		QString pattern{};
+		QStringList strings{};
 
+		RegExp regExp{};
+		QList<QStringMatcher> matchers{};
+		std::once_flag compiled{};
 	};
 
+	const ADBRegExp& compiledRegExp() const;
+
 	ADBRegExp* m_regExp{nullptr};
 
 	RuleType m_type;
@@ -177,6 +192,11 @@ private:
 
 	friend class SearchTree;
 
+	friend class TokenIndex;
+
+	friend QDataStream& operator<<(QDataStream& stream, const Rule& rule);
+	friend QDataStream& operator>>(QDataStream& stream, Rule& rule);
+
 	friend class Subscription;
 };
 }
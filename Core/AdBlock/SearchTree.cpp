@@ -24,28 +24,37 @@
 
 #include "AdBlock/SearchTree.hpp"
 
+#include <algorithm>
+#include <iterator>
+
 #include <QtDebug>
 
+#include "AdBlock/FilterCache.hpp"
+#include "AdBlock/RequestContext.hpp"
 #include "AdBlock/Rule.hpp"
 
 namespace Sn {
 namespace ADB {
 
-SearchTree::SearchTree() :
-		m_root(new Node)
+SearchTree::SearchTree()
 {
-	// Empty
+	clear();
 }
 
 SearchTree::~SearchTree()
 {
-	deleteNode(m_root);
+	// Empty
 }
 
 void SearchTree::clear()
 {
-	deleteNode(m_root);
-	m_root = new Node;
+	m_rules.clear();
+	m_nodes.clear();
+	m_edgeChars.clear();
+	m_edgeTargets.clear();
+	m_outputs.clear();
+
+	std::fill(std::begin(m_rootTable), std::end(m_rootTable), -1);
 }
 
 bool SearchTree::add(const Rule* rule)
@@ -53,95 +62,234 @@ bool SearchTree::add(const Rule* rule)
 	if (rule->m_type != Rule::StringContainsMatchRule)
 		return false;
 
-	const QString filter{rule->m_matchString};
-	int length{filter.size()};
-
-	if (length <= 0) {
+	if (rule->m_matchString.size() <= 0) {
 		qDebug() << "ADB::SearchTree: Inserting rule with filter length <= 0!";
 		return false;
 	}
 
-	Node* node = m_root;
+	m_rules.append(rule);
 
-	for (const QChar c : filter) {
-		if (!node->children.contains(c)) {
-			Node* n{new Node};
-			n->c = c;
+	return true;
+}
+
+void SearchTree::build()
+{
+	m_nodes.clear();
+	m_edgeChars.clear();
+	m_edgeTargets.clear();
+	m_outputs.clear();
 
-			node->children[c] = n;
+	std::fill(std::begin(m_rootTable), std::end(m_rootTable), -1);
+
+	// Plain trie first, urls are matched lowercased so patterns are folded the same way
+	QVector<PendingNode> trie{};
+	trie.append(PendingNode());
+
+	foreach (const Rule* rule, m_rules) {
+		int node{0};
+
+		for (const QChar c : rule->m_matchString) {
+			const ushort key{c.toLower().unicode()};
+			int child{trie[node].children.value(key, -1)};
+
+			if (child < 0) {
+				child = trie.size();
+				trie[node].children.insert(key, child);
+				trie.append(PendingNode());
+			}
+
+			node = child;
 		}
 
-		node = node->children[c];
+		trie[node].rules.append(rule);
 	}
 
-	node->rule = rule;
+	// Flatten in BFS order, so the nodes visited first are also the closest in memory
+	QVector<int> order{};
+	QVector<int> newIndex(trie.size(), -1);
 
-	return true;
+	order.reserve(trie.size());
+	order.append(0);
+	newIndex[0] = 0;
+
+	for (int i{0}; i < order.size(); ++i) {
+		QMapIterator<ushort, int> it{trie[order[i]].children};
+
+		while (it.hasNext()) {
+			it.next();
+			newIndex[it.value()] = order.size();
+			order.append(it.value());
+		}
+	}
+
+	m_nodes.resize(order.size());
+
+	for (int i{0}; i < order.size(); ++i) {
+		const PendingNode& pending{trie[order[i]]};
+		Node& node{m_nodes[i]};
+
+		node.firstEdge = m_edgeChars.size();
+		node.edgeCount = pending.children.size();
+		node.firstOutput = m_outputs.size();
+		node.outputCount = pending.rules.size();
+
+		QMapIterator<ushort, int> it{pending.children};
+
+		while (it.hasNext()) {
+			it.next();
+			m_edgeChars.append(it.key());
+			m_edgeTargets.append(newIndex[it.value()]);
+		}
+
+		m_outputs.append(pending.rules);
+	}
+
+	const Node& root{m_nodes[0]};
+
+	for (int i{0}; i < root.edgeCount; ++i) {
+		const ushort c{m_edgeChars[root.firstEdge + i]};
+
+		if (c < 128)
+			m_rootTable[c] = m_edgeTargets[root.firstEdge + i];
+	}
+
+	// Failure and output links, parents always come before their children in BFS order
+	for (int i{0}; i < m_nodes.size(); ++i) {
+		const Node parent{m_nodes[i]};
+
+		for (int j{0}; j < parent.edgeCount; ++j) {
+			const ushort c{m_edgeChars[parent.firstEdge + j]};
+			Node& child{m_nodes[m_edgeTargets[parent.firstEdge + j]]};
+
+			int fail{0};
+
+			if (i != 0) {
+				int state{parent.fail};
+				int next{transition(state, c)};
+
+				while (next < 0 && state != 0) {
+					state = m_nodes[state].fail;
+					next = transition(state, c);
+				}
+
+				fail = next < 0 ? 0 : next;
+			}
+
+			child.fail = fail;
+			child.outputLink = m_nodes[fail].outputCount > 0 ? fail : m_nodes[fail].outputLink;
+		}
+	}
 }
 
-const Rule* SearchTree::find(const Engine::UrlRequestInfo& request, const QString& domain,
-							 const QString& urlString) const
+const Rule* SearchTree::find(const RequestContext& context) const
 {
+	const QString& urlString{context.urlString()};
 	int length{urlString.size()};
 
-	if (length <= 0)
+	if (length <= 0 || m_nodes.size() <= 1)
 		return nullptr;
 
 	const QChar* string{urlString.constData()};
+	const Node* nodes{m_nodes.constData()};
+	const Rule* const* outputs{m_outputs.constData()};
+
+	int state{0};
 
 	for (int i{0}; i < length; ++i) {
-		const Rule* rule{prefixSearch(request, domain, urlString, ++string, length - i)};
-		if (rule)
-			return rule;
+		const ushort c{string[i].unicode()};
+		int next{transition(state, c)};
+
+		while (next < 0 && state != 0) {
+			state = nodes[state].fail;
+			next = transition(state, c);
+		}
+
+		state = next < 0 ? 0 : next;
+
+		int output{nodes[state].outputCount > 0 ? state : nodes[state].outputLink};
+
+		while (output > 0) {
+			const Node& node{nodes[output]};
+
+			for (int j{0}; j < node.outputCount; ++j) {
+				const Rule* rule{outputs[node.firstOutput + j]};
+
+				if (rule->networkMatch(context))
+					return rule;
+			}
+
+			output = node.outputLink;
+		}
 	}
 
 	return nullptr;
 }
 
-const Rule* SearchTree::prefixSearch(const Engine::UrlRequestInfo& request, const QString& domain,
-									 const QString& urlString, const QChar* string, int length) const
+void SearchTree::save(QDataStream& stream, const QHash<const Rule*, qint32>& ruleIds) const
 {
-	if (length <= 0)
-		return nullptr;
+	FilterCache::writeRuleIds(stream, m_rules, ruleIds);
+	FilterCache::writeRuleIds(stream, m_outputs, ruleIds);
 
-	QChar c{string[0]};
+	stream << static_cast<qint32>(m_nodes.size());
+	stream << static_cast<qint32>(m_edgeChars.size());
 
-	if (!m_root->children.contains(c))
-		return nullptr;
+	stream.writeRawData(reinterpret_cast<const char*>(m_nodes.constData()), m_nodes.size() * sizeof(Node));
+	stream.writeRawData(reinterpret_cast<const char*>(m_edgeChars.constData()), m_edgeChars.size() * sizeof(ushort));
+	stream.writeRawData(reinterpret_cast<const char*>(m_edgeTargets.constData()), m_edgeTargets.size() * sizeof(int));
+	stream.writeRawData(reinterpret_cast<const char*>(m_rootTable), sizeof(m_rootTable));
+}
+
+bool SearchTree::load(QDataStream& stream, const QVector<const Rule*>& rules)
+{
+	clear();
 
-	Node* node{m_root->children[c]};
+	if (!FilterCache::readRuleIds(stream, m_rules, rules)
+		|| !FilterCache::readRuleIds(stream, m_outputs, rules))
+		return false;
 
-	for (int i{1}; i < length; ++i) {
-		const QChar c{(++string)[0]};
+	qint32 nodesCount{0};
+	qint32 edgesCount{0};
 
-		if (node->rule && node->rule->networkMatch(request, domain, urlString))
-			return node->rule;
-		if (!node->children.contains(c))
-			return nullptr;
+	stream >> nodesCount;
+	stream >> edgesCount;
 
-		node = node->children[c];
-	}
+	if (nodesCount < 0 || edgesCount < 0 || stream.status() != QDataStream::Ok)
+		return false;
 
-	if (node->rule && node->rule->networkMatch(request, domain, urlString))
-		return node->rule;
+	m_nodes.resize(nodesCount);
+	m_edgeChars.resize(edgesCount);
+	m_edgeTargets.resize(edgesCount);
 
-	return nullptr;
+	const int nodesSize{static_cast<int>(nodesCount * sizeof(Node))};
+	const int charsSize{static_cast<int>(edgesCount * sizeof(ushort))};
+	const int targetsSize{static_cast<int>(edgesCount * sizeof(int))};
+
+	if (stream.readRawData(reinterpret_cast<char*>(m_nodes.data()), nodesSize) != nodesSize
+		|| stream.readRawData(reinterpret_cast<char*>(m_edgeChars.data()), charsSize) != charsSize
+		|| stream.readRawData(reinterpret_cast<char*>(m_edgeTargets.data()), targetsSize) != targetsSize
+		|| stream.readRawData(reinterpret_cast<char*>(m_rootTable), sizeof(m_rootTable)) != sizeof(m_rootTable)) {
+		clear();
+		return false;
+	}
+
+	return true;
 }
 
-void SearchTree::deleteNode(Node* node)
+int SearchTree::transition(int state, ushort c) const
 {
-	if (!node)
-		return;
+	if (state == 0 && c < 128)
+		return m_rootTable[c];
 
-	QHashIterator<QChar, Node*> iterator{node->children};
+	const Node& node{m_nodes.at(state)};
+	const ushort* begin{m_edgeChars.constData() + node.firstEdge};
+	const ushort* end{begin + node.edgeCount};
+	const ushort* it{std::lower_bound(begin, end, c)};
 
-	while (iterator.hasNext()) {
-		iterator.next();
-		deleteNode(iterator.value());
-	}
+	if (it == end || *it != c)
+		return -1;
 
-	delete node;
-};
+	return m_edgeTargets.at(node.firstEdge + static_cast<int>(it - begin));
+}
 
 }
-}
\ No newline at end of file
+}
@@ -29,7 +29,10 @@
 #include "SharedDefines.hpp"
 
 #include <QChar>
+#include <QDataStream>
 #include <QHash>
+#include <QMap>
+#include <QVector>
 
 #include <QWebEngine/UrlRequestInfo.hpp>
 
@@ -37,6 +40,14 @@ namespace Sn {
 namespace ADB {
 class Rule;
 
+class RequestContext;
+
+/*
+ * Aho-Corasick automaton over the StringContainsMatchRule patterns. Rules are
+ * staged with add() and compiled by build() into flat arrays (nodes in BFS
+ * order, sorted edges, failure and output links), so find() reports every
+ * candidate rule in a single linear pass over the url.
+ */
 class SIELO_SHAREDLIB SearchTree {
 public:
 	SearchTree();
@@ -45,25 +56,37 @@ public:
 	void clear();
 
 	bool add(const Rule* rule);
-	const Rule* find(const Engine::UrlRequestInfo& request, const QString& domain, const QString& urlString) const;
+	void build();
+
+	const Rule* find(const RequestContext& context) const;
+
+	void save(QDataStream& stream, const QHash<const Rule*, qint32>& ruleIds) const;
+	bool load(QDataStream& stream, const QVector<const Rule*>& rules);
 
 private:
 	struct Node {
-		QChar c{};
-		const Rule* rule{nullptr};
-		QHash<QChar, Node*> children;
+		int firstEdge{0};
+		int edgeCount{0};
+		int fail{0};
+		int outputLink{-1};
+		int firstOutput{0};
+		int outputCount{0};
+	};
 
-		Node() :
-				c(0),
-				rule(nullptr) {}
+	struct PendingNode {
+		QMap<ushort, int> children{};
+		QVector<const Rule*> rules{};
 	};
 
-	const Rule* prefixSearch(const Engine::UrlRequestInfo& request, const QString& domain, const QString& urlString,
-							 const QChar* string, int length) const;
+	inline int transition(int state, ushort c) const;
 
-	void deleteNode(Node* node);
+	QVector<const Rule*> m_rules{};
 
-	Node* m_root{nullptr};
+	QVector<Node> m_nodes{};
+	QVector<ushort> m_edgeChars{};
+	QVector<int> m_edgeTargets{};
+	QVector<const Rule*> m_outputs{};
+	int m_rootTable[128];
 };
 
 }
@@ -24,6 +24,8 @@
 
 #include "AdBlock/Subscription.hpp"
 
+#include <QtConcurrent/QtConcurrentRun>
+
 #include <QFile>
 
 #include <QTimer>
@@ -40,17 +42,27 @@ namespace ADB {
 
 static const QString ADBLOCK_EASYLIST_URL = "https://easylist-downloads.adblockplus.org/easylist.txt";
 
+Subscription::RuleStorage::~RuleStorage()
+{
+	qDeleteAll(rules);
+}
+
 Subscription::Subscription(const QString& title, QObject* parent) :
 		QObject(parent),
+		m_storage(std::make_shared<RuleStorage>()),
+		m_parseWatcher(new QFutureWatcher<QVector<Rule*>>(this)),
 		m_title(title),
 		m_updated(false)
 {
-	// Empty
+	connect(m_parseWatcher, &QFutureWatcher<QVector<Rule*>>::finished, this, &Subscription::subscriptionParsed);
 }
 
 Subscription::~Subscription()
 {
-	qDeleteAll(m_rules);
+	if (m_parseWatcher->isRunning()) {
+		m_parseWatcher->waitForFinished();
+		qDeleteAll(m_parseWatcher->result());
+	}
 }
 
 void Subscription::setFilePath(const QString& path)
@@ -72,35 +84,15 @@ void Subscription::loadSubscription(const QStringList& disabledRules)
 		return;
 	}
 
-	if (!file.open(QFile::ReadOnly)) {
-		qWarning() << "ADB::Subscription: " << __FUNCTION__ << "Unable to open adblock file for reading " << m_filePath;
-		QTimer::singleShot(0, this, &Subscription::updateSubscription);
-	}
+	QVector<Rule*> rules{};
 
-	QTextStream textStream{&file};
-
-	textStream.setCodec("UTF-8");
-	textStream.readLine(1024);
-	textStream.readLine(1024);
-
-	QString header{textStream.readLine(1024)};
-
-	if (!header.startsWith(QLatin1String("[Adblock")) || m_title.isEmpty()) {
-		qWarning() << "ADB::Subscription: " << __FUNCTION__ << " invalid format of adblock file! " << m_filePath;
+	if (m_title.isEmpty() || !parseFile(m_filePath, disabledRules, this, rules)) {
+		qDeleteAll(rules);
 		QTimer::singleShot(0, this, &Subscription::updateSubscription);
 		return;
 	}
 
-	m_rules.clear();
-
-	while (!textStream.atEnd()) {
-		Rule* rule{new Rule(textStream.readLine(), this)};
-
-		if (disabledRules.contains(rule->filter()))
-			rule->setEnabled(false);
-
-		m_rules.append(rule);
-	}
+	setRules(rules);
 
 	if (m_rules.isEmpty() && !m_updated)
 		QTimer::singleShot(0, this, &Subscription::updateSubscription);
@@ -181,7 +173,7 @@ const Rule* Subscription::replaceRule(Rule* rule, int offset)
 
 void Subscription::updateSubscription()
 {
-	if (m_reply || !m_url.isValid())
+	if (m_reply || m_parseWatcher->isRunning() || !m_url.isValid())
 		return;
 
 	m_reply = Application::instance()->networkManager()->get(QNetworkRequest(m_url));
@@ -240,11 +232,100 @@ void Subscription::subscriptionDownloaded()
 		return;
 	}
 
-	loadSubscription(Manager::instance()->disabledRules());
+	const QString filePath{m_filePath};
+	const QStringList disabledRules{Manager::instance()->disabledRules()};
+
+	// Rules only keep a pointer to their subscription, the parsing itself doesn't touch it
+	m_parseWatcher->setFuture(QtConcurrent::run([filePath, disabledRules, this]() {
+		QVector<Rule*> rules{};
+
+		if (!parseFile(filePath, disabledRules, this, rules)) {
+			qDeleteAll(rules);
+			rules.clear();
+		}
+
+		return rules;
+	}));
+};
+
+void Subscription::subscriptionParsed()
+{
+	const QVector<Rule*> rules{m_parseWatcher->result()};
+
+	if (rules.isEmpty()) {
+		emit subscriptionError(tr("Cannot load subscription!"));
+		return;
+	}
+
+	setRules(rules);
 
 	emit subscriptionUpdated();
 	emit subscriptionChanged();
-};
+}
+
+void Subscription::setRules(const QVector<Rule*>& rules)
+{
+	// The previous storage is released once no matcher snapshot uses it anymore
+	m_storage = std::make_shared<RuleStorage>();
+	m_storage->rules = rules;
+
+	m_rules = rules;
+}
+
+void Subscription::adoptRule(Rule* rule)
+{
+	m_storage->rules.append(rule);
+}
+
+void Subscription::retireRule(Rule* rule)
+{
+	// The current storage is left owning only the retired rule, so it is deleted with
+	// the last snapshot built before the change. The other rules move to a new storage,
+	// kept alive by the old one as long as those snapshots use them too.
+	std::shared_ptr<RuleStorage> storage{std::make_shared<RuleStorage>()};
+
+	storage->rules = m_storage->rules;
+	storage->rules.removeOne(rule);
+
+	m_storage->rules = {rule};
+	m_storage->next = storage;
+	m_storage = storage;
+}
+
+bool Subscription::parseFile(const QString& filePath, const QStringList& disabledRules, Subscription* subscription,
+							 QVector<Rule*>& rules)
+{
+	QFile file{filePath};
+
+	if (!file.open(QFile::ReadOnly)) {
+		qWarning() << "ADB::Subscription: " << __FUNCTION__ << "Unable to open adblock file for reading " << filePath;
+		return false;
+	}
+
+	QTextStream textStream{&file};
+
+	textStream.setCodec("UTF-8");
+	textStream.readLine(1024);
+	textStream.readLine(1024);
+
+	QString header{textStream.readLine(1024)};
+
+	if (!header.startsWith(QLatin1String("[Adblock"))) {
+		qWarning() << "ADB::Subscription: " << __FUNCTION__ << " invalid format of adblock file! " << filePath;
+		return false;
+	}
+
+	while (!textStream.atEnd()) {
+		Rule* rule{new Rule(textStream.readLine(), subscription)};
+
+		if (disabledRules.contains(rule->filter()))
+			rule->setEnabled(false);
+
+		rules.append(rule);
+	}
+
+	return true;
+}
 
 }
 }
\ No newline at end of file
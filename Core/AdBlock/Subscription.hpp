@@ -28,8 +28,12 @@
 
 #include "SharedDefines.hpp"
 
+#include <memory>
+
 #include <QVector>
 
+#include <QFutureWatcher>
+
 #include <QUrl>
 #include <QNetworkReply>
 
@@ -37,10 +41,24 @@ namespace Sn {
 namespace ADB {
 class Rule;
 
+class FilterCache;
+
 class SIELO_SHAREDLIB Subscription : public QObject {
 Q_OBJECT
 
 public:
+	/*
+	 * Owns every rule created for the subscription. Matcher snapshots keep a
+	 * reference to it, so rules stay alive until no snapshot can use them.
+	 * A storage whose rules were retired keeps the storage that replaced it.
+	 */
+	struct RuleStorage {
+		~RuleStorage();
+
+		QVector<Rule*> rules{};
+		std::shared_ptr<RuleStorage> next{};
+	};
+
 	Subscription(const QString& title, QObject* parent = nullptr);
 	~Subscription();
 
@@ -59,6 +77,7 @@ public:
 
 	const Rule* rule(int offset) const;
 	QVector<Rule*> allRulles() const;
+	std::shared_ptr<RuleStorage> ruleStorage() const { return m_storage; }
 
 	const Rule* enableRule(int offset);
 	const Rule* disableRule(int offset);
@@ -82,19 +101,32 @@ public slots:
 protected:
 	virtual bool saveDownloadedData(const QByteArray& data);
 
+	void setRules(const QVector<Rule*>& rules);
+	void adoptRule(Rule* rule);
+	void retireRule(Rule* rule);
+
 	QNetworkReply* m_reply{nullptr};
 	QVector<Rule*> m_rules;
 
 protected slots:
 	void subscriptionDownloaded();
+	void subscriptionParsed();
 
 private:
+	static bool parseFile(const QString& filePath, const QStringList& disabledRules, Subscription* subscription,
+						  QVector<Rule*>& rules);
+
+	std::shared_ptr<RuleStorage> m_storage{};
+	QFutureWatcher<QVector<Rule*>>* m_parseWatcher{nullptr};
+
 	QString m_title{};
 	QString m_filePath{};
 
 	QUrl m_url{};
 
 	bool m_updated{false};
+
+	friend class FilterCache;
 };
 
 }
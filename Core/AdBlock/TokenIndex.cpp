@@ -0,0 +1,325 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "AdBlock/TokenIndex.hpp"
+
+#include <algorithm>
+
+#include <QStringList>
+
+#include "AdBlock/FilterCache.hpp"
+#include "AdBlock/RequestContext.hpp"
+#include "AdBlock/Rule.hpp"
+
+namespace Sn {
+namespace ADB {
+
+static inline bool isTokenChar(ushort c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '%';
+}
+
+static inline uint hashToken(const QChar* string, int length)
+{
+	// FNV-1a, ascii case folded so rules and urls don't have to be lowered first
+	uint hash{2166136261u};
+
+	for (int i{0}; i < length; ++i) {
+		ushort c{string[i].unicode()};
+
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+
+		hash ^= c;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static const QVector<uint>& badTokens()
+{
+	static const QVector<uint> tokens = [] {
+		QVector<uint> hashes{};
+		const QStringList words{"http", "https", "www", "com", "net", "org", "js", "html"};
+
+		for (const QString& word : words)
+			hashes.append(hashToken(word.constData(), word.size()));
+
+		return hashes;
+	}();
+
+	return tokens;
+}
+
+TokenIndex::TokenIndex()
+{
+	// Empty
+}
+
+TokenIndex::~TokenIndex()
+{
+	// Empty
+}
+
+void TokenIndex::clear()
+{
+	m_rules.clear();
+	m_buckets.clear();
+	m_untokenizedRules.clear();
+}
+
+void TokenIndex::add(const Rule* rule)
+{
+	m_rules.append(rule);
+}
+
+void TokenIndex::build()
+{
+	m_buckets.clear();
+	m_untokenizedRules.clear();
+
+	QVector<QVector<uint>> tokensPerRule{};
+	QHash<uint, int> frequency{};
+
+	tokensPerRule.reserve(m_rules.size());
+
+	foreach (const Rule* rule, m_rules) {
+		const QVector<uint> tokens{ruleTokens(rule)};
+
+		for (uint token : tokens)
+			++frequency[token];
+
+		tokensPerRule.append(tokens);
+	}
+
+	const QVector<uint>& bad{badTokens()};
+
+	for (int i{0}; i < m_rules.size(); ++i) {
+		const QVector<uint>& tokens{tokensPerRule[i]};
+
+		if (tokens.isEmpty()) {
+			m_untokenizedRules.append(m_rules[i]);
+			continue;
+		}
+
+		uint bestToken{tokens[0]};
+		int bestWeight{-1};
+
+		for (uint token : tokens) {
+			int weight{frequency.value(token)};
+
+			if (bad.contains(token))
+				weight += m_rules.size();
+
+			if (bestWeight < 0 || weight < bestWeight) {
+				bestToken = token;
+				bestWeight = weight;
+			}
+		}
+
+		m_buckets[bestToken].append(m_rules[i]);
+	}
+}
+
+const Rule* TokenIndex::find(const RequestContext& context, const Tokens& urlTokens) const
+{
+	for (uint token : urlTokens) {
+		auto it = m_buckets.constFind(token);
+
+		if (it == m_buckets.constEnd())
+			continue;
+
+		for (const Rule* rule : it.value()) {
+			if (rule->networkMatch(context))
+				return rule;
+		}
+	}
+
+	for (const Rule* rule : m_untokenizedRules) {
+		if (rule->networkMatch(context))
+			return rule;
+	}
+
+	return nullptr;
+}
+
+void TokenIndex::save(QDataStream& stream, const QHash<const Rule*, qint32>& ruleIds) const
+{
+	FilterCache::writeRuleIds(stream, m_rules, ruleIds);
+	FilterCache::writeRuleIds(stream, m_untokenizedRules, ruleIds);
+
+	stream << static_cast<qint32>(m_buckets.size());
+
+	for (auto it = m_buckets.constBegin(); it != m_buckets.constEnd(); ++it) {
+		stream << static_cast<quint32>(it.key());
+		FilterCache::writeRuleIds(stream, it.value(), ruleIds);
+	}
+}
+
+bool TokenIndex::load(QDataStream& stream, const QVector<const Rule*>& rules)
+{
+	clear();
+
+	if (!FilterCache::readRuleIds(stream, m_rules, rules)
+		|| !FilterCache::readRuleIds(stream, m_untokenizedRules, rules))
+		return false;
+
+	qint32 bucketsCount{0};
+	stream >> bucketsCount;
+
+	if (bucketsCount < 0 || stream.status() != QDataStream::Ok)
+		return false;
+
+	m_buckets.reserve(bucketsCount);
+
+	for (qint32 i{0}; i < bucketsCount; ++i) {
+		quint32 token{0};
+		QVector<const Rule*> bucket{};
+
+		stream >> token;
+
+		if (!FilterCache::readRuleIds(stream, bucket, rules))
+			return false;
+
+		m_buckets.insert(token, bucket);
+	}
+
+	return true;
+}
+
+void TokenIndex::tokenize(const QString& urlString, Tokens& tokens)
+{
+	tokens.clear();
+
+	const QChar* string{urlString.constData()};
+	const int length{urlString.size()};
+	int i{0};
+
+	while (i < length) {
+		if (!isTokenChar(string[i].unicode())) {
+			++i;
+			continue;
+		}
+
+		const int start{i};
+
+		while (i < length && isTokenChar(string[i].unicode()))
+			++i;
+
+		if (i - start < 2)
+			continue;
+
+		const uint token{hashToken(string + start, i - start)};
+
+		if (!std::any_of(tokens.constBegin(), tokens.constEnd(), [token](uint t) { return t == token; }))
+			tokens.append(token);
+	}
+}
+
+QVector<uint> TokenIndex::ruleTokens(const Rule* rule)
+{
+	QString pattern{};
+	bool leftAnchored{false};
+	bool rightAnchored{false};
+
+	if (rule->m_type == Rule::DomainMatchRule) {
+		pattern = rule->m_matchString;
+		leftAnchored = true;
+		rightAnchored = true;
+	}
+	else if (rule->m_type == Rule::StringEndsMatchRule) {
+		pattern = rule->m_matchString;
+		rightAnchored = true;
+	}
+	else if (rule->m_type == Rule::StringContainsMatchRule) {
+		pattern = rule->m_matchString;
+	}
+	else if (rule->m_type == Rule::RegExpMatchRule) {
+		pattern = rule->m_filter;
+
+		if (pattern.startsWith(QLatin1String("@@")))
+			pattern = pattern.mid(2);
+
+		int optionsIndex{pattern.indexOf(QLatin1Char('$'))};
+
+		if (optionsIndex >= 0)
+			pattern = pattern.left(optionsIndex);
+
+		// Real regular expressions can't be tokenized safely
+		if (pattern.startsWith(QLatin1Char('/')) && pattern.endsWith(QLatin1Char('/')))
+			return QVector<uint>();
+
+		if (pattern.startsWith(QLatin1String("||"))) {
+			pattern = pattern.mid(2);
+			leftAnchored = true;
+		}
+		else if (pattern.startsWith(QLatin1Char('|'))) {
+			pattern = pattern.mid(1);
+			leftAnchored = true;
+		}
+
+		if (pattern.endsWith(QLatin1Char('|'))) {
+			pattern.chop(1);
+			rightAnchored = true;
+		}
+	}
+	else {
+		return QVector<uint>();
+	}
+
+	// A token is only usable if the url can't extend it, so it must be bounded
+	// by a literal separator or an anchor on both sides
+	QVector<uint> tokens{};
+	const QChar* string{pattern.constData()};
+	const int length{pattern.size()};
+	int i{0};
+
+	while (i < length) {
+		if (!isTokenChar(string[i].unicode())) {
+			++i;
+			continue;
+		}
+
+		const int start{i};
+
+		while (i < length && isTokenChar(string[i].unicode()))
+			++i;
+
+		const bool leftBounded{start == 0 ? leftAnchored : string[start - 1] != QLatin1Char('*')};
+		const bool rightBounded{i == length ? rightAnchored : string[i] != QLatin1Char('*')};
+
+		if (leftBounded && rightBounded && i - start >= 2) {
+			const uint token{hashToken(string + start, i - start)};
+
+			if (!tokens.contains(token))
+				tokens.append(token);
+		}
+	}
+
+	return tokens;
+}
+
+}
+}
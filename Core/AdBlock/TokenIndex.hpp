@@ -0,0 +1,83 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_ADBTOKENINDEX_HPP
+#define SIELOBROWSER_ADBTOKENINDEX_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QDataStream>
+#include <QHash>
+#include <QVector>
+#include <QVarLengthArray>
+
+#include <QWebEngine/UrlRequestInfo.hpp>
+
+namespace Sn {
+namespace ADB {
+class Rule;
+
+class RequestContext;
+
+/*
+ * Index for the network rules the SearchTree can't handle (regexp, domain and
+ * ends-with rules). Each rule is bucketed by its rarest alphanumeric token, the
+ * request url is tokenized once and only the buckets of its tokens are checked.
+ * Rules without any safe token stay in a small list that is always scanned.
+ */
+class SIELO_SHAREDLIB TokenIndex {
+public:
+	using Tokens = QVarLengthArray<uint, 64>;
+
+	TokenIndex();
+	~TokenIndex();
+
+	void clear();
+
+	void add(const Rule* rule);
+	void build();
+
+	int count() const { return m_rules.count(); }
+
+	const Rule* find(const RequestContext& context, const Tokens& urlTokens) const;
+
+	void save(QDataStream& stream, const QHash<const Rule*, qint32>& ruleIds) const;
+	bool load(QDataStream& stream, const QVector<const Rule*>& rules);
+
+	static void tokenize(const QString& urlString, Tokens& tokens);
+
+private:
+	static QVector<uint> ruleTokens(const Rule* rule);
+
+	QVector<const Rule*> m_rules{};
+
+	QHash<uint, QVector<const Rule*>> m_buckets{};
+	QVector<const Rule*> m_untokenizedRules{};
+};
+
+}
+}
+
+#endif //SIELOBROWSER_ADBTOKENINDEX_HPP
@@ -34,7 +34,7 @@ UrlInterceptor::UrlInterceptor(Manager* manager) :
 	BaseUrlInterceptor(manager),
 	m_manager(manager)
 {
-	// Empty
+	setObjectName(QStringLiteral("AdBlock"));
 }
 
 void UrlInterceptor::interceptRequest(Engine::UrlRequestInfo& info)
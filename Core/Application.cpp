@@ -40,6 +40,9 @@
 #include <QFontDatabase>
 
 #include <QMessageBox>
+#include <QSaveFile>
+
+#include <QDebug>
 
 #include <QWebEngine/WebSettings.hpp>
 
@@ -67,6 +70,7 @@
 #include "Utils/DataPaths.hpp"
 #include "Utils/Updater.hpp"
 #include "Utils/RestoreManager.hpp"
+#include "Utils/SessionJournal.hpp"
 #include "Utils/Settings.hpp"
 #include "Utils/SideBarManager.hpp"
 
@@ -74,6 +78,8 @@
 #include "Web/Scripts.hpp"
 #include "Web/HTML5Permissions/HTML5PermissionsManager.hpp"
 #include "Web/Tab/TabbedWebView.hpp"
+#include "Web/Tab/TabLifecycleManager.hpp"
+#include "Web/Tab/TabRestoreScheduler.hpp"
 
 #include "Network/NetworkManager.hpp"
 
@@ -396,6 +402,9 @@ Application::~Application()
 	if (m_windows.count() > 0)
 		saveSession();
 
+	if (m_sessionJournal)
+		m_sessionJournal->flush();
+
 	QThreadPool::globalInstance()->waitForDone();
 
 	delete m_plugins;
@@ -416,6 +425,11 @@ void Application::loadSettings()
 
 	m_networkManager->loadSettings();
 
+	if (m_tabRestoreScheduler)
+		m_tabRestoreScheduler->loadSettings();
+
+	tabLifecycleManager()->loadSettings();
+
 	// Check if the user have enable the witcher font
 	if (1) {
 		QWebEngineSettings* webSettings = QWebEngineSettings::defaultSettings();
@@ -886,6 +900,21 @@ void Application::saveSession(bool saveForHome)
 	if (m_privateBrowsing || m_isRestoring || m_windows.count() == 0 || m_restoreManager)
 		return;
 
+	// Tabs still waiting to be restored would be missing from the saved session
+	for (BrowserWindow* window : m_windows) {
+		for (TabWidget* tabWidget : window->tabsSpaceSplitter()->tabWidgets())
+			tabWidget->finishRestore();
+	}
+
+	// The running session only appends the tabs that changed to its journal
+	if (!saveForHome) {
+		if (!m_sessionJournal)
+			m_sessionJournal = new SessionJournal(DataPaths::currentProfilePath() + QLatin1String("/session.dat"), this);
+
+		m_sessionJournal->save(m_windows);
+		return;
+	}
+
 	QByteArray data{};
 	QDataStream stream{&data, QIODevice::WriteOnly};
 
@@ -904,15 +933,15 @@ void Application::saveSession(bool saveForHome)
 	stream << restoreData;
 
 	// Save data to a file
-	QFile file{};
-	if (saveForHome)
-		file.setFileName(DataPaths::currentProfilePath() + QLatin1String("/home-session.dat"));
-	else
-		file.setFileName(DataPaths::currentProfilePath() + QLatin1String("/session.dat"));
+	QSaveFile file{DataPaths::currentProfilePath() + QLatin1String("/home-session.dat")};
+
+	if (!file.open(QIODevice::WriteOnly)) {
+		qWarning() << "Unable to save the home session" << file.errorString();
+		return;
+	}
 
-	file.open(QIODevice::WriteOnly);
 	file.write(data);
-	file.close();
+	file.commit();
 }
 
 void Application::reloadUserStyleSheet()
@@ -1063,6 +1092,22 @@ CookieJar *Application::cookieJar()
 	return m_cookieJar;
 }
 
+TabRestoreScheduler *Application::tabRestoreScheduler()
+{
+	if (!m_tabRestoreScheduler)
+		m_tabRestoreScheduler = new TabRestoreScheduler(this);
+
+	return m_tabRestoreScheduler;
+}
+
+TabLifecycleManager *Application::tabLifecycleManager()
+{
+	if (!m_tabLifecycleManager)
+		m_tabLifecycleManager = new TabLifecycleManager(this);
+
+	return m_tabLifecycleManager;
+}
+
 History *Application::history()
 {
 	if (!m_history)
@@ -57,6 +57,9 @@ class SideBarInterface;
 
 struct RestoreData;
 class RestoreManager;
+class SessionJournal;
+class TabRestoreScheduler;
+class TabLifecycleManager;
 
 class BrowserWindow;
 
@@ -243,6 +246,8 @@ public:
 	HTML5PermissionsManager *permissionsManager();
 	NetworkManager *networkManager() const { return m_networkManager; }
 	RestoreManager *restoreManager() const { return m_restoreManager; }
+	TabRestoreScheduler *tabRestoreScheduler();
+	TabLifecycleManager *tabLifecycleManager();
 
 	Engine::WebProfile *webProfile();
 
@@ -359,6 +364,9 @@ private:
 	Engine::WebProfile* m_webProfile{nullptr};
 
 	RestoreManager* m_restoreManager{nullptr};
+	SessionJournal* m_sessionJournal{nullptr};
+	TabRestoreScheduler* m_tabRestoreScheduler{nullptr};
+	TabLifecycleManager* m_tabLifecycleManager{nullptr};
 
 	QList<BrowserWindow*> m_windows;
 	QPointer<BrowserWindow> m_lastActiveWindow;
@@ -39,6 +39,10 @@
 #include <QTimer>
 #include <QMessageBox>
 
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <QWebSocketCorsAuthenticator>
+
 #include "Bookmarks/BookmarksUtils.hpp"
 #include "Bookmarks/BookmarksToolbar.hpp"
 
@@ -46,9 +50,11 @@
 
 #include "Plugins/PluginProxy.hpp"
 
+#include "Utils/BackdropBlur.hpp"
 #include "Utils/DataPaths.hpp"
 #include "Utils/RestoreManager.hpp"
 #include "Utils/Settings.hpp"
+#include "Utils/WallpaperWatcher.hpp"
 
 #include "Web/LoadRequest.hpp"
 #include "Web/WebPage.hpp"
@@ -73,10 +79,6 @@
 #endif
 
 #endif
-QT_BEGIN_NAMESPACE
-extern Q_WIDGETS_EXPORT void qt_blurImage(QPainter *p, QImage &blurImage, qreal radius, bool quality, bool alphaOnly, int transposed = 0);
-QT_END_NAMESPACE
-
 #ifdef Q_OS_WIN
 bool DWMEnabled(void)
 {
@@ -206,7 +208,8 @@ BrowserWindow::BrowserWindow(Application::WindowType type, const QUrl& url) :
 	QMainWindow(nullptr),
 	m_startUrl(url),
 	m_windowType(type),
-	m_backgroundTimer(new QTimer())
+	m_backdropBlur(new BackdropBlur(this)),
+	m_backdropTimer(new QTimer(this))
 {
     plog::init(plog::debug, "Sielo.log");
     PLOGD << "start run\n\n"; 
@@ -240,21 +243,23 @@ BrowserWindow::BrowserWindow(Application::WindowType type, const QUrl& url) :
 
     loadSettings();
 
-    connect(m_backgroundTimer, &QTimer::timeout, this, &BrowserWindow::loadWallpaperSettings);
-    m_backgroundTimer->start(1000);
+    connect(WallpaperWatcher::instance(), &WallpaperWatcher::wallpaperChanged, this, &BrowserWindow::applyWallpaper);
+
+    // Resizing only shoots the backdrop again once the size settles
+    m_backdropTimer->setSingleShot(true);
+    m_backdropTimer->setInterval(150);
+    connect(m_backdropTimer, &QTimer::timeout, this, &BrowserWindow::shotBackground);
+    connect(m_backdropBlur, &BackdropBlur::blurred, this, [this](const QImage& image)
+    {
+        m_blur_bg = image;
+        update();
+    });
 
     // Just wait some milli seconds before doing some post launch action
     QTimer::singleShot(10, this, &BrowserWindow::postLaunch);
 
-    connect(this, SIGNAL(signalzoom(int)), this, SLOT(doZoom(int)));
-    connect(this, SIGNAL(signalgoNewUrl(QString)), this, SLOT(goNewUrl(QString)));
 #endif
 
- 
-    connect(this, SIGNAL(signalopenPanit(bool)), this, SLOT(openPanit(bool)));
-    connect(this, SIGNAL(signalsetcolor(QString)), this, SLOT(setColor(QString)));
-    connect(this, SIGNAL(signalclearPanit()), this, SLOT(clearPanit()));
-
     HttpServer::instance(0, this)->start();
 }
 
@@ -309,45 +314,25 @@ void BrowserWindow::loadSettings()
 
 void BrowserWindow::loadWallpaperSettings()
 {
-	if (!m_backgroundTimer->isActive()) 
-		m_backgroundTimer->start(100);
-
-	Settings settings{};
+	WallpaperWatcher::instance()->reload();
 
-	QString backgroundPath = settings.value(QLatin1String("Settings/backgroundPath"), QString()).toString();
-
-#ifdef Q_OS_WIN 
-	QSettings wallpaperSettings{"HKEY_CURRENT_USER\\Control Panel\\Desktop", QSettings::NativeFormat};
-	QString wallpaper{wallpaperSettings.value("WallPaper", QString()).toString()};
-	wallpaper.replace("\\", "/");
-
-		if (backgroundPath.isEmpty())
-			backgroundPath = wallpaper;
-#endif
+	// The watcher only notifies on changes, windows opened later need the current wallpaper
+	if (WallpaperWatcher::instance()->path() != m_wallpaperPath)
+		applyWallpaper(WallpaperWatcher::instance()->path(), WallpaperWatcher::instance()->image());
+}
 
+void BrowserWindow::applyWallpaper(const QString& path, const QImage& image)
+{
+	m_wallpaperPath = path;
 
-	QImage newBackground{backgroundPath};
-	
 	// Themes can have default backgound. If the user don't have custom background, we apply it.
-	// However, if the user have a custom background we override the default one
-	if (!backgroundPath.isEmpty() && newBackground != m_currentBackground) {
-		QString sss{};
-		sss += "QMainWindow {";
-		sss += "border-image: url(" + backgroundPath + ") 0 0 0 0 stretch stretch;";
-		sss += "border-width: 0px;";
-
-		//if (settings.value(QLatin1String("Settings/repeatBackground"), false).toBool())
-		//	sss += "background-repeat: repeat;";
-		//else
-		//	sss += "background-repeat: no-repeat;";
+	// However, if the user have a custom background we override the default one, painted from
+	// the image the watcher decoded for every window
+	m_wallpaper = path.isEmpty() ? QImage() : image;
+	m_scaledWallpaper = QPixmap();
 
-		sss += "}";
-
-		setStyleSheet(sss);
-
-		m_currentBackground = newBackground;
-		m_upd_ss = true; // Citorva will explain this.
-	}
+	m_upd_ss = true; // Citorva will explain this.
+	update();
 }
 
 void BrowserWindow::setStartTab(WebTab* tab)
@@ -468,12 +453,13 @@ TabWidget *BrowserWindow::tabWidget(int index) const
 
 const QImage *BrowserWindow::background()
 {
-	return m_bg;
+	// The blurred background is what is painted, don't report a background before it is ready
+	return m_blur_bg.isNull() ? nullptr : &m_bg;
 }
 
 const QImage *BrowserWindow::processedBackground()
 {
-	return m_blur_bg;
+	return m_blur_bg.isNull() ? nullptr : &m_blur_bg;
 }
 
 void BrowserWindow::setWindowTitle(const QString& title)
@@ -552,9 +538,17 @@ void BrowserWindow::shotBackground()
 	if (m_fButton) m_fButton->hide();
 	m_titleBar->hide();
 
-	QPixmap *bg = new QPixmap(size());
-	render(bg, QPoint(), QRect(0, 0, width(), height()));
-	m_bg = new QImage(bg->toImage());
+	// The blur is done at reduced resolution, so render the window directly at that resolution
+	const qreal scale{BackdropBlur::scaleForRadius(m_blur_radius)};
+	QImage background{(QSizeF(size()) * scale).toSize().expandedTo(QSize(1, 1)), QImage::Format_ARGB32_Premultiplied};
+	background.fill(Qt::transparent);
+
+	{
+		QPainter painter{&background};
+		painter.scale(scale, scale);
+		render(&painter, QPoint(), QRegion(0, 0, width(), height()));
+	}
+
 	m_tabsSpaceSplitter->show();
 	//m_titleBar->show(); 地址栏/关闭,最大,最小化窗口栏!
 
@@ -563,65 +557,26 @@ void BrowserWindow::shotBackground()
 //		m_fButton->move(pos);
 		m_fButton->hide();
 	}
-	m_blur_bg = new QImage(applyBlur(m_bg, m_blur_radius));
-}
 
-QImage BrowserWindow::applyBlur(const QImage *src, qreal radius, bool quality, bool alphaOnly, int transposed)
-{
-	QPixmap ret(src->size());
-	QPainter painter(&ret);
-	{
-		QPixmap big(QSize(src->width() + 2 * radius, src->height() + 2 * radius));
-		QPainter big_painter(&big);
-
-		big_painter.drawImage(QPoint(radius, radius), src->copy());
-
-		{
-			QPixmap	left(QSize(1, big.height())),
-				right(QSize(1, big.height()));
-
-			QPainter painter_left(&left),
-				painter_right(&right);
-
-			painter_left.drawImage(QPoint(0, radius), src->copy());
-			painter_right.drawImage(QPoint(1 - src->width(), radius), src->copy());
-
-			for (int i = 0; i < radius; i++) {
-				big_painter.drawImage(QPoint(i, 0), left.toImage());
-				big_painter.drawImage(QPoint(radius + src->width() + i, 0), right.toImage());
-			}
-		}
-
-		{
-			QPixmap top(QSize(big.width(), 1)),
-				bottom(QSize(big.width(), 1));
-
-			QPainter painter_top(&top),
-				painter_bottom(&bottom);
-
-			painter_top.drawImage(QPoint(0, -radius), big.toImage());
-			painter_bottom.drawImage(QPoint(0, 1 + radius - big.height()), big.toImage());
-
-			for (int i = 0; i < radius; i++) {
-				big_painter.drawImage(QPoint(0, i), top.toImage());
-				big_painter.drawImage(QPoint(0, radius + src->height() + i), bottom.toImage());
-			}
-		}
-
-		QImage bgImage{big.toImage()};
-		qt_blurImage(&big_painter, bgImage, radius, quality, alphaOnly, transposed);
-		painter.drawImage(QPoint(-radius, -radius), big.toImage());
-	}
-	return ret.toImage();
+	m_bg = background;
+	m_backdropBlur->blur(background, size(), m_blur_radius);
 }
 
 void BrowserWindow::paintEvent(QPaintEvent* event)
 {
 	// Citorva will explain this
 	QMainWindow::paintEvent(event);
+
+	if (!m_wallpaper.isNull()) {
+		if (m_scaledWallpaper.size() != size())
+			m_scaledWallpaper = QPixmap::fromImage(m_wallpaper.scaled(size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+
+		QPainter painter{this};
+		painter.drawPixmap(event->rect(), m_scaledWallpaper, event->rect());
+	}
 	if (m_upd_ss) {
 		m_upd_ss = false;
-		shotBackground();
+		m_backdropTimer->start();
 	}
 }
 
@@ -637,7 +592,7 @@ void BrowserWindow::resizeEvent(QResizeEvent* event)
 
 	QMainWindow::resizeEvent(event);
 
-	shotBackground();
+	m_backdropTimer->start();
 }
 
 void BrowserWindow::keyPressEvent(QKeyEvent* event)
@@ -1109,23 +1064,62 @@ void BrowserWindow::removeCaption(const QWidget* widget)
 	}
 }
 
-void BrowserWindow::dosignalopenPanit(bool r){
-    Q_EMIT signalopenPanit(r);
-}
+void BrowserWindow::processRemoteCommands()
+{
+    RemoteCommandQueue* queue = HttpServer::instance()->commands();
+    RemoteCommand command;
 
-void BrowserWindow::dosignalclearPanit() {
-    Q_EMIT signalclearPanit();
-}
+    // Unschedule first, commands pushed while draining schedule a new pass
+    queue->unschedule();
 
-void BrowserWindow::dosignalzoom(int n) {
-    Q_EMIT signalzoom(n);
-}
+    while (queue->pop(command)) {
+        if (command.type != RemoteCommand::Ink)
+            PLOGD << "do cmd type :" << RemoteCommand::typeToString(command.type).toStdString() << " data :" << command.data.toStdString();
 
-void BrowserWindow::dosignalsetcolor(QString r) {
-    Q_EMIT signalsetcolor(r);
-}
-void BrowserWindow::dosignalgoNewUrl(QString r) {
-    Q_EMIT signalgoNewUrl(r);
+        switch (command.type) {
+        case RemoteCommand::Paint:	//打开画板
+            if (command.data.toInt() == 1)
+                openPanit(true);
+            else if (command.data.toInt() == 0)
+                openPanit(false);
+            break;
+        case RemoteCommand::Shape:	//形状
+            if (DrawWidget::self)
+                DrawWidget::self->setShape(command.data.toInt());
+            else
+                PLOGD << "do cmd set shape err:no widget  " << command.data.toInt();
+            break;
+        case RemoteCommand::Width:	//设置粗细
+            if (DrawWidget::self)
+                DrawWidget::self->setWidth(command.data.toInt());
+            else
+                PLOGD << "do cmd set width err:no widget  " << command.data.toInt();
+            break;
+        case RemoteCommand::Url:	//跳转网址
+            if (!command.data.isEmpty())
+                goNewUrl(QString::fromUtf8(command.data));
+            break;
+        case RemoteCommand::Color:	//颜色
+            if (!command.data.isEmpty())
+                setColor(QString::fromUtf8(command.data));
+            break;
+        case RemoteCommand::Ink:	//远程笔迹
+            if (DrawWidget::self)
+                DrawWidget::self->addInk(InkStream::decode(command.data));
+            else
+                PLOGD << "do cmd ink err:no widget";
+            break;
+        case RemoteCommand::Clear:
+            clearPanit();
+            break;
+        case RemoteCommand::Zoom:
+            doZoom(command.data.toInt());
+            break;
+        default:
+            PLOGE << "unknow cmd type  " << command.type;
+            break;
+        }
+    }
 }
 
 bool BrowserWindow::isCaption(const QWidget* widget)
@@ -1162,6 +1156,9 @@ bool BrowserWindow::nativeEvent(const QByteArray &eventType, void *message, long
 		if (res != HTNOWHERE)
 			hasHandled = true;
 	}
+	else if (wMessage == WM_SETTINGCHANGE && wMsg->wParam == SPI_SETDESKWALLPAPER) {
+		WallpaperWatcher::instance()->reload();
+	}
 	//else if (wMessage == WM_NCPAINT)
 	//	hasHandled = true;
 
@@ -1525,6 +1522,13 @@ void ScreenWidget::contextMenuEvent(QContextMenuEvent *)
 }
 
 #include <QColorDialog>
+
+// Longest delay, in milliseconds, between receiving a remote ink sample and drawing it
+static const qint64 INK_MAX_LAG = 100;
+// Strokes kept for the replay, the canvas keeps everything drawn since the last clear
+static const int MAX_STROKES = 500;
+static const int MAX_STROKE_POINTS = 4096;
+
 DrawWidget *DrawWidget::self = 0;
 DrawWidget::DrawWidget(QWidget *parent) :
 	QWidget(parent)
@@ -1546,7 +1550,6 @@ DrawWidget::DrawWidget(QWidget *parent) :
     pix.fill((QColor(0, 0, 0, 1)));
     image = pix.toImage();
 
-	tempImage = image;  //将临时画布设置成与主画布相同的状态
 	drawing = false;    //默认未绘图
 	nshape = 0;			//默认涂鸦,画笔,形状
 
@@ -1565,6 +1568,9 @@ DrawWidget::DrawWidget(QWidget *parent) :
 
 	penWidth->setValue(3);
 	penColor.setNamedColor("red");
+
+	inkTimer.setSingleShot(true);
+	connect(&inkTimer, &QTimer::timeout, this, &DrawWidget::drainInk);
 }
 
 DrawWidget::~DrawWidget()
@@ -1574,17 +1580,19 @@ DrawWidget::~DrawWidget()
 void DrawWidget::paintEvent(QPaintEvent *event) //重写窗口重绘事件
 {
 	/*
-	 *采用双缓冲绘图，以矩形为例，当绘制矩形时，
-	 * 鼠标左键未松开（移动），将图形绘制在临时画布（即预览）
-	 * 在鼠标松开后，将临时画布上的图形copy到主画布上，
-	 * 显示主画布
+	 * 只重绘脏区域：先画主画布上已完成的笔迹，
+	 * 鼠标拖动时再在上面画预览的形状，
+	 * 鼠标松开后形状才写入主画布
 	 * */
+	const QRect rect{event->rect()};
+
 	QPainter painter(this);
-	if (drawing == true){
-		painter.drawImage(0, 0, tempImage);		//鼠标按住但在拖动时在临时画布上画
-	}
-	else {
-		painter.drawImage(0, 0, image);			//在image上绘画
+	painter.drawImage(rect, image, rect);
+
+	if (drawing && !preview.points.isEmpty()) {
+		painter.setClipRect(rect);
+		painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+		drawStroke(painter, preview);
 	}
 }
 
@@ -1627,42 +1635,158 @@ void drawArrow(QPoint startPoint, QPoint endPoint, QPainter &p, QColor penColor)
 	p.fillPath(path, QBrush(penColor));
 }
 
-void DrawWidget::paint(QImage &theImage)        //绘图
+void DrawWidget::drawStroke(QPainter& painter, const Stroke& stroke)
 {
-    QPen pen(penColor, penWidth->value(), Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+	if (stroke.points.isEmpty())
+		return;
 
-    QPainter thePainter(&theImage);
-    thePainter.setPen(pen);
-    thePainter.setRenderHint(QPainter::HighQualityAntialiasing, true);
-    thePainter.setCompositionMode(QPainter::CompositionMode_Source);
+	const QPoint first{stroke.points.first()};
+	const QPoint last{stroke.points.last()};
 
-	//绘图
-	switch (nshape) {
-	case 0:thePainter.drawLine(change, point);
-		change = point;
+	painter.setPen(QPen(stroke.color, stroke.width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+	painter.setBrush(Qt::NoBrush);
+
+	switch (stroke.shape) {
+	case 0:
+		for (int i{1}; i < stroke.points.count(); ++i) {
+			QPen pen{painter.pen()};
+			pen.setWidthF(qMax(1.0, stroke.width * (i < stroke.pressures.count() ? stroke.pressures[i] : 1.0)));
+			painter.setPen(pen);
+			painter.drawLine(stroke.points[i - 1], stroke.points[i]);
+		}
+		break;
+	case 1:
+		drawArrow(first, last, painter, stroke.color);
 		break;
-	case 1: 
-		drawArrow(from, point, thePainter, penColor);
-		break;   
-	case 2:thePainter.drawRect(from.x(), from.y(), width, heigh);
+	case 2:
+		painter.drawRect(first.x(), first.y(), last.x() - first.x(), last.y() - first.y());
 		break;
-// 	case 3:thePainter.eraseRect(point.x(), point.y(), penWidth->value() + 5, penWidth->value() + 5);
-// 		break;
-	case 4:thePainter.drawEllipse(from.x(), from.y(), width, heigh);
+	case 4:
+		painter.drawEllipse(first.x(), first.y(), last.x() - first.x(), last.y() - first.y());
 		break;
 	case 5:
-		lineEdit.move(point.x(), point.y());
-		lineEdit.setVisible(true);
-		thePainter.drawText(change, lineEdit.text());
-		lineEdit.clear();
-		if (lineEdit.text() != ""){
-			lineEdit.setVisible(false);
-		}
+		painter.drawText(first, stroke.text);
+		break;
+	default:
 		break;
-	default:break;
 	}
-	thePainter.end(); //结束绘图
-	update();   //窗口重绘
+}
+
+QRect DrawWidget::strokeRect(const Stroke& stroke)
+{
+	if (stroke.points.isEmpty())
+		return QRect();
+
+	QRect rect{QPolygon(stroke.points).boundingRect()};
+	int margin{stroke.width / 2 + 2};
+
+	if (stroke.shape == 1)
+		margin = qMax(margin, 32); // Arrow head
+	else if (stroke.shape == 5)
+		rect = QFontMetrics(QFont()).boundingRect(stroke.text).translated(stroke.points.first());
+
+	return rect.adjusted(-margin, -margin, margin, margin);
+}
+
+QImage DrawWidget::renderStrokes(const QSize& size) const
+{
+	QImage result{size, QImage::Format_ARGB32_Premultiplied};
+	result.fill(Qt::transparent);
+
+	if (image.isNull() || size.isEmpty())
+		return result;
+
+	QPainter painter{&result};
+	painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+	painter.scale(static_cast<qreal>(size.width()) / image.width(),
+				  static_cast<qreal>(size.height()) / image.height());
+
+	for (const Stroke& stroke : strokes)
+		drawStroke(painter, stroke);
+
+	return result;
+}
+
+DrawWidget::Stroke DrawWidget::makeStroke(const QVector<QPoint>& points, const QString& text) const
+{
+	Stroke stroke{};
+	stroke.shape = nshape;
+	stroke.color = penColor;
+	stroke.width = penWidth->value();
+	stroke.points = points;
+	stroke.pressures.fill(1.0, points.count());
+	stroke.text = text;
+
+	return stroke;
+}
+
+void DrawWidget::commit(const Stroke& stroke)
+{
+	QPainter painter{&image};
+	painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+	painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+	drawStroke(painter, stroke);
+}
+
+void DrawWidget::updatePreview(const Stroke& stroke)
+{
+	const QRect rect{strokeRect(stroke)};
+
+	update(rect.united(previewRect));
+
+	preview = stroke;
+	previewRect = rect;
+}
+
+int DrawWidget::appendStroke(const Stroke& stroke)
+{
+	strokes.append(stroke);
+
+	// Drop the oldest strokes, but never one still being drawn
+	int excess{strokes.count() - MAX_STROKES};
+
+	if (currentStroke >= 0)
+		excess = qMin(excess, currentStroke);
+	if (inkStroke >= 0)
+		excess = qMin(excess, inkStroke);
+
+	if (excess > 0) {
+		strokes.remove(0, excess);
+
+		if (currentStroke >= 0)
+			currentStroke -= excess;
+		if (inkStroke >= 0)
+			inkStroke -= excess;
+	}
+
+	return strokes.count() - 1;
+}
+
+void DrawWidget::drawSegment(int& index, const QPoint& to, qreal pressure)
+{
+	// A pen that is never lifted continues in a new stroke, so old points can be dropped too
+	if (strokes[index].points.count() >= MAX_STROKE_POINTS) {
+		Stroke next{strokes[index]};
+		next.points = {next.points.last()};
+		next.pressures = {next.pressures.last()};
+
+		index = appendStroke(next);
+	}
+
+	// Freehand strokes go straight to the canvas, one segment at a time
+	Stroke& stroke{strokes[index]};
+	Stroke segment{stroke};
+
+	segment.points = {stroke.points.last(), to};
+	segment.pressures = {pressure, pressure};
+
+	commit(segment);
+
+	stroke.points.append(to);
+	stroke.pressures.append(pressure);
+
+	update(strokeRect(segment));
 }
 
 void DrawWidget::setupUi()
@@ -1897,35 +2021,167 @@ void DrawWidget::setColor(QString n)
     }
 }
 
-void DrawWidget::mousePressEvent(QMouseEvent *event)
+void DrawWidget::beginStroke(const QPoint& pos)
 {
-	if (event->button() == Qt::LeftButton) {
-		qDebug() << "mouse LeftButton" << event->pos().rx() << ":" << event->pos().ry();
-		drawing = true;
-		point = event->pos();
-		from = event->pos();
-		change = event->pos();
-		width = 0; heigh = 0;
-		pointPolygon[0] = point;
-		pointPolygon[1].setX(point.x());
+	drawing = true;
+	point = pos;
+	from = pos;
+	change = pos;
+	width = 0; heigh = 0;
+	pointPolygon[0] = point;
+	pointPolygon[1].setX(point.x());
+
+	if (nshape == 0) {
+		currentStroke = -1;
+		currentStroke = appendStroke(makeStroke({point}));
 	}
 }
 
-void DrawWidget::mouseMoveEvent(QMouseEvent *event)
+void DrawWidget::moveStroke(const QPoint& pos)
 {
-	point = event->pos();
+	point = pos;
 	width = point.x() - from.x();
 	heigh = point.y() - from.y();
 	pointPolygon[1].setY(point.y());
 	pointPolygon[2] = point;
-	tempImage = image;
 
-	if (nshape == 0 || nshape == 3) {
-		paint(image);
+	if (!drawing)
+		return;
+
+	switch (nshape) {
+	case 0:
+		if (currentStroke >= 0) {
+			drawSegment(currentStroke, point);
+			change = point;
+		}
+		break;
+	case 3:
+		break;
+	case 5:
+		lineEdit.move(point.x(), point.y());
+		lineEdit.setVisible(true);
+		updatePreview(makeStroke({change}, lineEdit.text()));
+		lineEdit.clear();
+		break;
+	default:
+		updatePreview(makeStroke({from, point}));
+		break;
 	}
-	else {
-		paint(tempImage);
+}
+
+void DrawWidget::endStroke(const QPoint& pos)
+{
+	to = pos;
+	point = pos;
+	width = to.x() - from.x();
+	heigh = to.y() - from.y();
+	pointPolygon[2] = point;
+	drawing = false;
+
+	Stroke stroke{};
+
+	switch (nshape) {
+	case 0:
+		if (currentStroke >= 0 && point != change)
+			drawSegment(currentStroke, point);
+		currentStroke = -1;
+		break;
+	case 3:
+		break;
+	case 5:
+		lineEdit.move(point.x(), point.y());
+		lineEdit.setVisible(true);
+		stroke = makeStroke({change}, lineEdit.text());
+		lineEdit.clear();
+		break;
+	default:
+		stroke = makeStroke({from, point});
+		break;
+	}
+
+	if (!stroke.points.isEmpty() && (stroke.shape != 5 || !stroke.text.isEmpty())) {
+		commit(stroke);
+		appendStroke(stroke);
+	}
+
+	update(strokeRect(stroke).united(previewRect));
+
+	preview = Stroke();
+	previewRect = QRect();
+}
+
+void DrawWidget::addInk(const QVector<Sn::InkSample>& samples)
+{
+	if (samples.isEmpty())
+		return;
+
+	// Samples are replayed at the pace they were captured, so a batch is drawn as a
+	// smooth stroke instead of all at once. The clock is anchored on the first sample
+	// that arrives while nothing is pending.
+	if (inkSamples.isEmpty()) {
+		inkClock.start();
+		inkOrigin = samples.first().time;
 	}
+
+	for (const Sn::InkSample& sample : samples)
+		inkSamples.enqueue(sample);
+
+	drainInk();
+}
+
+void DrawWidget::drainInk()
+{
+	if (inkSamples.isEmpty())
+		return;
+
+	qint64 now{inkOrigin + inkClock.elapsed()};
+
+	// Skip ahead rather than lagging the controller more than INK_MAX_LAG
+	if (inkSamples.last().time - now > INK_MAX_LAG) {
+		inkOrigin += inkSamples.last().time - now - INK_MAX_LAG;
+		now = inkOrigin + inkClock.elapsed();
+	}
+
+	while (!inkSamples.isEmpty() && inkSamples.head().time <= now)
+		drawInk(inkSamples.dequeue());
+
+	if (!inkSamples.isEmpty())
+		inkTimer.start(static_cast<int>(inkSamples.head().time - now));
+}
+
+void DrawWidget::drawInk(const Sn::InkSample& sample)
+{
+	// Remote ink is always freehand and keeps its own stroke, the local shape,
+	// drag and text box are left alone
+	if (sample.flags & Sn::InkSample::Down) {
+		Stroke stroke{};
+		stroke.color = penColor;
+		stroke.width = penWidth->value();
+		stroke.points = {sample.position};
+		stroke.pressures = {sample.pressure};
+
+		inkStroke = -1;
+		inkStroke = appendStroke(stroke);
+	}
+	else if (inkStroke >= 0) {
+		drawSegment(inkStroke, sample.position, sample.pressure);
+	}
+
+	if (sample.flags & Sn::InkSample::Up)
+		inkStroke = -1;
+}
+
+void DrawWidget::mousePressEvent(QMouseEvent *event)
+{
+	if (event->button() == Qt::LeftButton) {
+		qDebug() << "mouse LeftButton" << event->pos().rx() << ":" << event->pos().ry();
+		beginStroke(event->pos());
+	}
+}
+
+void DrawWidget::mouseMoveEvent(QMouseEvent *event)
+{
+	moveStroke(event->pos());
 }
 
 void DrawWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -1933,14 +2189,7 @@ void DrawWidget::mouseReleaseEvent(QMouseEvent *event)
 	if (event->button() == Qt::LeftButton)
 	{
 		qDebug() << "mouse LeftButton "<< event->pos().rx()<<":"<< event->pos().ry();
-		to = event->pos();
-		point = event->pos();
-		width = to.x() - from.x();
-		heigh = to.y() - from.y();
-		pointPolygon[2] = point;
-		drawing = false;
-
-		paint(image);
+		endStroke(event->pos());
 	}
 }
 
@@ -1999,7 +2248,13 @@ void DrawWidget::on_pushButton_3_clicked()
     QPixmap pix(this->size().width(), this->size().height());
     pix.fill((QColor(0, 0, 0, 1)));
     image = pix.toImage();
-    tempImage = pix.toImage();
+	strokes.clear();
+	currentStroke = -1;
+	inkStroke = -1;
+	inkSamples.clear();
+	inkTimer.stop();
+	preview = Stroke();
+	previewRect = QRect();
 	update();
     PLOGD << "do signalclearPanit end";
 }
@@ -2033,104 +2288,57 @@ void HttpServer::run() {
     }
 
     PLOGD << "start listen 8010";
-    exec();
-}
 
-struct MouseData {
-    int type;
-    int action;
-    int x;
-    int y;
-};
+    // Persistent channel, same JSON or binary batches as the /commands endpoint
+    QWebSocketServer webSocketServer(QStringLiteral("Sielo"), QWebSocketServer::NonSecureMode);
+    // Browsers always send an Origin with the handshake and our controller app never does,
+    // refuse those so a visited page can not drive the window through ws://localhost:8011
+    connect(&webSocketServer, &QWebSocketServer::originAuthenticationRequired, &webSocketServer,
+            [](QWebSocketCorsAuthenticator* authenticator) {
+        if (!authenticator->origin().isEmpty()) {
+            PLOGE << "refusing websocket from origin " << authenticator->origin().toStdString();
+            authenticator->setAllowed(false);
+        }
+    });
+    connect(&webSocketServer, &QWebSocketServer::newConnection, &webSocketServer, [&]() {
+        while (QWebSocket* socket = webSocketServer.nextPendingConnection()) {
+            connect(socket, &QWebSocket::textMessageReceived, socket, [this, socket](const QString& message) {
+                if (!post(Sn::RemoteCommand::fromJson(message.toUtf8())))
+                    socket->sendTextMessage(QStringLiteral("busy"));
+            });
+            connect(socket, &QWebSocket::binaryMessageReceived, socket, [this, socket](const QByteArray& message) {
+                if (!post(Sn::RemoteCommand::fromBinary(message)))
+                    socket->sendTextMessage(QStringLiteral("busy"));
+            });
+            connect(socket, &QWebSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    });
+
+    if (webSocketServer.listen(QHostAddress::Any, 8011))
+        PLOGD << "start websocket listen 8011";
+    else
+        PLOGE << "can not listen websocket on 8011: " << webSocketServer.errorString().toStdString();
 
-std::string typeToString(int t) {
-    switch (t)
-    {
-    case 0:return "close panit";
-    case 1:return "open panit";
-    case 2:return "set shape";
-    case 3:return "set width";
-    case 4:return "set url";
-    case 6:return "set color";
-    case 7:return "clear paint";
-    case 8:return "zoom";
-    default:
-        break;
-    }
+    exec();
 }
 
-void HttpServer::gDealHttp(int type, QByteArray data)
+bool HttpServer::post(const QVector<Sn::RemoteCommand>& commands)
 {
-    PLOGD << "do cmd type :" << typeToString(type) <<" data :"<< data.toStdString() <<" hand:"<< m_hand;
-    if (type == 1) {	//打开画板
-        if (data.toInt() == 1 && m_hand) {
-            ((Sn::BrowserWindow*)m_hand)->dosignalopenPanit(true);
-        }
-        else if (data.toInt() == 0 && m_hand) {
-            ((Sn::BrowserWindow*)m_hand)->dosignalopenPanit(false);
-        }
-    }
-    else if (type == 2) {	//形状
-        int i = 0;
-        do{
-            if (!DrawWidget::self) {
-                Sleep(100);
-            }
-            else {
-                DrawWidget::self->setShape(data.toInt());
-            }
-        } while (i++ < 3);
-
-        if (!DrawWidget::self){
-            PLOGD << "do cmd set shape err:no widget  " << data.toInt();
-        }
-    }
-    else if (type == 3) {	//设置粗细
-        int i = 0;
-        do {
-            if (!DrawWidget::self) {
-                Sleep(100);
-            }
-            else {
-                DrawWidget::self->setWidth(data.toInt());
-            }
-        } while (i++ < 3);
-
-        if (!DrawWidget::self) {
-            PLOGD << "do cmd set width err:no widget  " << data.toInt();
-        }
-    }
-    else if (type == 4 && m_hand) {	//跳转网址
-        if (data.size()) {
-            ((Sn::BrowserWindow*)m_hand)->dosignalgoNewUrl(data.data());
-        }
-    }
-   /* else if (type == 5) {
-        QJsonDocument json = QJsonDocument::fromJson(data.data(), 0);
-        QJsonObject obj = json.object();
-
-        int x = (obj["x"].toInt() & 0xFFFF) / (65535 / float(1920));
-        int y = (obj["y"].toInt() & 0xFFFF) / (65535 / float(1080));
-
-        ((Sn::BrowserWindow*)m_hand)->postMouseEvent(
-            (Sn::ButtonType)obj["type"].toInt(),
-            (Sn::ButtonAction)obj["action"].toInt(),
-            x,
-            y);
-        PLOGD << "do cmd set mouse  " << " x:"<<x<<" y:"<<y;
-    }*/
-    else if (type == 6) { //颜色
-        if (data.size()) {
-            ((Sn::BrowserWindow*)m_hand)->dosignalsetcolor(data.data());
+    bool accepted = true;
+
+    for (const Sn::RemoteCommand& command : commands) {
+        if (!m_commands.push(command)) {
+            PLOGE << "remote command queue is full, dropping " << commands.size() << " commands";
+            accepted = false;
+            break;
         }
     }
-    else if (type == 7 && m_hand) {
-        ((Sn::BrowserWindow*)m_hand)->dosignalclearPanit();
-    }
-    else if (type == 8 && m_hand) {
-        ((Sn::BrowserWindow*)m_hand)->dosignalzoom(data.toInt());
-    }
-    else {
-        PLOGE << "unknow cmd type  " << type;
+
+    // A single wake up per burst, the GUI thread drains everything queued so far
+    if (m_hand && m_commands.schedule()) {
+        auto window = static_cast<Sn::BrowserWindow*>(m_hand);
+        QMetaObject::invokeMethod(window, [window]() { window->processRemoteCommands(); }, Qt::QueuedConnection);
     }
+
+    return accepted;
 }
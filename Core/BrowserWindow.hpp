@@ -19,6 +19,8 @@
 #include <QMenu>
 #include <QPoint>
 #include <QSize>
+#include <QImage>
+#include <QPixmap>
 #include "Widgets/Tab/TabsSpaceSplitter.hpp"
 #include "Widgets/FloatingButton.hpp"
 
@@ -31,6 +33,9 @@
 #include "qhttpserverconnection.hpp"
 #include "qhttpserverrequest.hpp"
 #include "qhttpserverresponse.hpp"
+
+#include "Network/InkStream.hpp"
+#include "Network/RemoteCommand.hpp"
 #include <QtCore/QCoreApplication>
 #include <QDateTime>
 #include <QLocale>
@@ -52,13 +57,17 @@ public:
     Q_DISABLE_COPY(HttpServer)
 
     void run();
-    void gDealHttp(int type, QByteArray data);
+
+    // Must be called from the server thread, the queue has a single producer
+    bool post(const QVector<Sn::RemoteCommand>& commands);
+    Sn::RemoteCommandQueue* commands() { return &m_commands; }
 
 private:
 	long m_lasttick = 0;
 	bool m_screen = true;
 	bool isrun = false;
 	void* m_hand;
+	Sn::RemoteCommandQueue m_commands{};
 };
 
 #include <plog/Log.h>
@@ -73,8 +82,8 @@ public:
     explicit ClientHandler(quint64 id, QHttpRequest* req, QHttpResponse* res)
         : QObject(req /* as parent*/), iconnectionId(id) {
 
-        // automatically collect http body(data) upto 1KB
-        req->collectData(1024);
+        // automatically collect http body(data) upto 64KB, enough for command batches
+        req->collectData(64 * 1024);
 
         // when all the incoming data are gathered, send some response to client.
         req->onEnd([this, req, res]() {
@@ -86,25 +95,47 @@ public:
                 qPrintable(req->url().toString())
             );
 
+            // Same rule as the websocket channel: requests made by a web page carry an Origin
+            if (req->headers().has("origin")) {
+                res->setStatusCode(qhttp::ESTATUS_FORBIDDEN);
+                res->end();
+                return;
+            }
+
             // 处理消息
+            bool accepted = true;
             auto typesStr = req->url().toString();
-            if (typesStr.contains("/type=")) {
-                int type = typesStr.mid(typesStr.indexOf("/type=") + 6, 1).toInt();
+            if (req->url().path() == QLatin1String("/commands")) {
+                const QByteArray body = req->collectedData().trimmed();
+                if (body.startsWith('[') || body.startsWith('{'))
+                    accepted = HttpServer::instance()->post(Sn::RemoteCommand::fromJson(body));
+                else
+                    accepted = HttpServer::instance()->post(Sn::RemoteCommand::fromBinary(req->collectedData()));
+            }
+            else if (typesStr.contains("/type=")) {
+                int start = typesStr.indexOf("/type=") + 6;
+                int end = start;
+                while (end < typesStr.size() && typesStr.at(end).isDigit())
+                    ++end;
+                int type = typesStr.mid(start, end - start).toInt();
                 if (req->collectedData().size() > 0) {
                     QString url = req->collectedData().constData();
-                    dealMsg(type, url);
+                    accepted = dealMsg(type, url);
                 }
             }
 
-            QString message = QString("ok");
-            res->setStatusCode(qhttp::ESTATUS_OK);
+            QString message = QString(accepted ? "ok" : "busy");
+            res->setStatusCode(accepted ? qhttp::ESTATUS_OK : qhttp::ESTATUS_SERVICE_UNAVAILABLE);
             res->addHeaderValue("content-length", message.size());
             res->end(message.toUtf8());
         });
     }
 
-    void dealMsg(int t, QString d) {
-        HttpServer::instance()->gDealHttp(t, d.toLocal8Bit().data());
+    bool dealMsg(int t, QString d) {
+        Sn::RemoteCommand command;
+        command.type = t;
+        command.data = d.toUtf8();
+        return HttpServer::instance()->post({command});
     }
 
     virtual ~ClientHandler() {
@@ -124,6 +155,8 @@ class TabbedWebView;
 
 class TabWidget;
 
+class BackdropBlur;
+
 class RootFloatingButton;
 class TitleBar;
 class BookmarksToolbar;
@@ -228,19 +261,8 @@ public:
 	void removeCaption(const QWidget* widget);
 	bool isCaption(const QWidget* widget);  
 
-    void dosignalopenPanit(bool);
-    void dosignalgoNewUrl(QString);
-    void dosignalsetcolor(QString);
-    void dosignalclearPanit();
-    void dosignalzoom(int);
-
-Q_SIGNALS:
-    void signalopenPanit(bool);
-    void signalgoNewUrl(QString);
-    void signalsetcolor(QString);
-    void signalclearPanit();
-    void signalzoom(int);
-
+    // Run the commands queued by the remote control server
+    void processRemoteCommands();
 
 signals:
 	void mouseOver(bool state);
@@ -269,8 +291,8 @@ public slots:
 	void tabWidgetIndexChanged(TabWidget* tbWidget);
 
 protected:
+	void applyWallpaper(const QString& path, const QImage& image);
 	void shotBackground();
-	QImage applyBlur(const QImage *src, qreal radius, bool quality = true, bool alphaOnly = false, int transposed = 0);
 	void paintEvent(QPaintEvent* event);
 	void resizeEvent(QResizeEvent* event);
 	void keyPressEvent(QKeyEvent* event) override;
@@ -325,10 +347,13 @@ private:
 
 	RootFloatingButton* m_fButton{nullptr};
 
-	QTimer* m_backgroundTimer{nullptr};
-	QImage m_currentBackground{};
-	QImage* m_bg{ nullptr };
-	QImage* m_blur_bg{ nullptr };
+	BackdropBlur* m_backdropBlur{nullptr};
+	QTimer* m_backdropTimer{nullptr};
+	QString m_wallpaperPath{};
+	QImage m_wallpaper{};
+	QPixmap m_scaledWallpaper{};
+	QImage m_bg{};
+	QImage m_blur_bg{};
 	bool m_upd_ss{ false };
 	HttpServer* m_srv;
 };
@@ -415,6 +440,10 @@ private slots:
 #include <QLineEdit>
 #include <QLabel>
 #include <QSlider>
+#include <QPainter>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
 
 class DrawWidget : public QWidget
 {
@@ -436,9 +465,11 @@ public:
 		return self;
 	}
 	~DrawWidget();
-	void paint(QImage &theImage);
 	void setupUi();
 
+	QImage renderStrokes(const QSize& size) const;	//按任意分辨率重放矢量笔迹
+	void addInk(const QVector<Sn::InkSample>& samples);	//远程笔迹
+
 	void doClener();
 	void setShape(int n);
     void setWidth(int n);
@@ -446,9 +477,42 @@ public:
 
 	static DrawWidget *self;
 private:
+	struct Stroke {
+		int shape{0};
+		QColor color{};
+		int width{1};
+		QVector<QPoint> points{};
+		QVector<qreal> pressures{};
+		QString text{};
+	};
+
+	static void drawStroke(QPainter& painter, const Stroke& stroke);
+	static QRect strokeRect(const Stroke& stroke);
+
+	Stroke makeStroke(const QVector<QPoint>& points, const QString& text = QString()) const;
+	void commit(const Stroke& stroke);
+	void updatePreview(const Stroke& stroke);
+	int appendStroke(const Stroke& stroke);
+	void drawSegment(int& index, const QPoint& to, qreal pressure = 1.0);
+
+	void drawInk(const Sn::InkSample& sample);
+	void drainInk();
+
+	void beginStroke(const QPoint& pos);
+	void moveStroke(const QPoint& pos);
+	void endStroke(const QPoint& pos);
+
 	//绘画变量
-	QImage image;			//画布
-	QImage tempImage;		//临时画布（双缓冲绘图时应用）
+	QImage image;			//画布（已完成的笔迹）
+	QVector<Stroke> strokes;	//矢量笔迹（仅保留最近的笔迹）
+	Stroke preview;			//拖动中的形状（预览层）
+	QRect previewRect;		//预览层的脏区域
+	int currentStroke{-1};	//拖动中的涂鸦（本地）
+	int inkStroke{-1};		//绘制中的涂鸦（远程笔迹）
+	QQueue<Sn::InkSample> inkSamples;	//待回放的远程笔迹
+	QElapsedTimer inkClock;
+	qint64 inkOrigin{0};	//inkClock 起点对应的笔迹时间
+	QTimer inkTimer;
 	QColor setting_color;	//背景色
 	QColor penColor;		//画笔颜色
 	bool drawing;			//绘图状态
@@ -27,6 +27,12 @@
 #include <QDir>
 #include <QFile>
 #include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+
+#include <QUrl>
+
+#include <QDebug>
 
 #include <QMessageBox>
 
@@ -267,9 +273,95 @@ void ProfileManager::connectDatabase()
 
 	if (!db.open())
 		qWarning("Cannot open SQLite database! Continuing without database....");
+	else
+		updateDatabase(db);
 
 	SqlDatabase::instance()->setDatabase(db);
 
 	m_databaseConnected = true;
 }
+
+void ProfileManager::updateDatabase(QSqlDatabase& database) const
+{
+	QSqlQuery query{database};
+
+	if (!Application::instance()->privateBrowsing()) {
+		// History visits are written with an upsert on url
+		query.exec(QStringLiteral("CREATE UNIQUE INDEX IF NOT EXISTS historyUrl ON history(url ASC)"));
+
+		// The history manager pages visits on (date, id)
+		query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS historyDate ON history(date DESC)"));
+
+		// Full-text index of history for the address bar until HistoryCompletionIndex is loaded
+		// in memory. It is only rebuilt when created, so the triggers keep it current for the
+		// next start.
+		query.exec(QStringLiteral("SELECT 1 FROM sqlite_master WHERE type='table' AND name='history_fts'"));
+		const bool indexExists{query.next()};
+
+		if (!indexExists) {
+			database.transaction();
+
+			const bool created{query.exec(QStringLiteral(
+				"CREATE VIRTUAL TABLE history_fts USING fts5(url, title, content='history', content_rowid='id', "
+				"tokenize='unicode61 remove_diacritics 2', prefix='2 3')"))
+				&& query.exec(QStringLiteral(
+					"CREATE TRIGGER history_fts_insert AFTER INSERT ON history BEGIN "
+					"INSERT INTO history_fts(rowid, url, title) VALUES (new.id, new.url, new.title); END"))
+				&& query.exec(QStringLiteral(
+					"CREATE TRIGGER history_fts_delete AFTER DELETE ON history BEGIN "
+					"INSERT INTO history_fts(history_fts, rowid, url, title) "
+					"VALUES ('delete', old.id, old.url, old.title); END"))
+				&& query.exec(QStringLiteral(
+					"CREATE TRIGGER history_fts_update AFTER UPDATE OF url, title ON history "
+					"WHEN old.url IS NOT new.url OR old.title IS NOT new.title BEGIN "
+					"INSERT INTO history_fts(history_fts, rowid, url, title) "
+					"VALUES ('delete', old.id, old.url, old.title); "
+					"INSERT INTO history_fts(rowid, url, title) VALUES (new.id, new.url, new.title); END"))
+				&& query.exec(QStringLiteral("INSERT INTO history_fts(history_fts) VALUES ('rebuild')"))};
+
+			if (created)
+				database.commit();
+			else {
+				qWarning() << "Cannot create the history full-text index:" << query.lastError().text();
+				database.rollback();
+			}
+		}
+
+		// Favicons are looked up by host, a GLOB with a leading wildcard on url can't use any index
+		query.exec(QStringLiteral("SELECT 1 FROM pragma_table_info('icons') WHERE name='host'"));
+		const bool hostExists{query.next()};
+
+		if (!hostExists) {
+			database.transaction();
+
+			bool updated{query.exec(QStringLiteral("ALTER TABLE icons ADD COLUMN host TEXT"))};
+
+			if (updated) {
+				QSqlQuery icons{database};
+				icons.exec(QStringLiteral("SELECT id, url FROM icons"));
+
+				query.prepare(QStringLiteral("UPDATE icons SET host = ? WHERE id = ?"));
+
+				while (updated && icons.next()) {
+					query.bindValue(0, QUrl(icons.value(1).toString()).host());
+					query.bindValue(1, icons.value(0));
+					updated = query.exec();
+				}
+			}
+
+			if (updated)
+				database.commit();
+			else {
+				qWarning() << "Cannot add hosts to the icons table:" << query.lastError().text();
+				database.rollback();
+			}
+		}
+
+		query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS iconsHost ON icons(host ASC)"));
+		query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS iconsUrl ON icons(url ASC)"));
+	}
+
+	query.exec(QStringLiteral("SELECT 1 FROM sqlite_master WHERE type='table' AND name='history_fts'"));
+	SqlDatabase::instance()->setHistoryIndexed(query.next());
+}
 }
@@ -30,6 +30,8 @@
 
 #include <QString>
 
+#include <QSqlDatabase>
+
 namespace Sn
 {
 class SIELO_SHAREDLIB ProfileManager {
@@ -55,6 +57,7 @@ private:
 	void copyDataToProfile() const;
 
 	void connectDatabase();
+	void updateDatabase(QSqlDatabase& database) const;
 
 	bool m_databaseConnected{false};
 };
@@ -29,10 +29,40 @@
 
 #include <QCoreApplication>
 
+#include <QHash>
+
+#include <QSqlError>
+
+#include <QDebug>
+
 namespace  Sn
 {
 
-QThreadStorage<QSqlDatabase> s_databases;
+static const int MAX_PREPARED_QUERIES = 64;
+
+struct SqlDatabase::Connection {
+	~Connection();
+
+	QString name{};
+	int generation{-1};
+	bool isDefault{false};
+
+	QHash<QString, QSqlQuery> preparedQueries{};
+};
+
+SqlDatabase::Connection::~Connection()
+{
+	// Statements must be released before their connection is removed
+	preparedQueries.clear();
+
+	if (isDefault || name.isEmpty())
+		return;
+
+	QSqlDatabase::database(name, false).close();
+	QSqlDatabase::removeDatabase(name);
+}
+
+QThreadStorage<SqlDatabase::Connection*> s_connections;
 Q_GLOBAL_STATIC(SqlDatabase, sn_sql_database);
 
 SqlDatabase *SqlDatabase::instance() {
@@ -45,26 +75,106 @@ SqlDatabase::SqlDatabase(QObject* parent) :
 }
 
 QSqlDatabase SqlDatabase::database() const {
-	if (QThread::currentThread() == QCoreApplication::instance()->thread())
+	Connection* connection{localConnection()};
+
+	if (connection->isDefault)
 		return QSqlDatabase::database();
 
-	if (!s_databases.hasLocalData()) {
-		const QString threadStr{QString::number(reinterpret_cast<quintptr>(QThread::currentThread()))};
-		QSqlDatabase database{QSqlDatabase::addDatabase("QSQLITE", threadStr)};
+	return QSqlDatabase::database(connection->name, false);
+}
+
+void SqlDatabase::setDatabase(const QSqlDatabase& database) {
+	m_databaseName = database.databaseName();
+	m_connectOptions = database.connectOptions();
+
+	QSqlDatabase mainDatabase{database};
+	configure(mainDatabase, m_connectOptions.contains(QLatin1String("QSQLITE_OPEN_READONLY")));
 
-		database.setDatabaseName(m_databaseName);
-		database.setConnectOptions(m_connectOptions);
-		database.open();
+	// Connections of other threads are reopened on their next use
+	++m_generation;
 
-		s_databases.setLocalData(database);
+	// Statements must not outlive the database driver
+	connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &SqlDatabase::clearPreparedQueries,
+			Qt::UniqueConnection);
+}
+
+QSqlQuery SqlDatabase::preparedQuery(const QString& sql) const {
+	Connection* connection{localConnection()};
+	auto it = connection->preparedQueries.find(sql);
+
+	if (it != connection->preparedQueries.end()) {
+		it->finish();
+		return it.value();
 	}
 
-	return s_databases.localData();
+	if (connection->preparedQueries.size() >= MAX_PREPARED_QUERIES)
+		connection->preparedQueries.clear();
+
+	QSqlQuery query{database()};
+
+	if (!query.prepare(sql))
+		qWarning() << "SqlDatabase: Cannot prepare" << sql << query.lastError().text();
+
+	connection->preparedQueries.insert(sql, query);
+
+	return query;
 }
 
-void SqlDatabase::setDatabase(const QSqlDatabase& database) {
-	m_databaseName = database.databaseName();
-	m_connectOptions = database.connectOptions();
+void SqlDatabase::setHistoryIndexed(bool indexed) {
+	m_historyIndexed = indexed;
+}
+
+void SqlDatabase::clearPreparedQueries() {
+	if (s_connections.hasLocalData())
+		s_connections.localData()->preparedQueries.clear();
+}
+
+SqlDatabase::Connection *SqlDatabase::localConnection() const {
+	if (!s_connections.hasLocalData())
+		s_connections.setLocalData(new Connection());
+
+	Connection* connection{s_connections.localData()};
+	const int generation{m_generation};
+
+	if (connection->generation == generation)
+		return connection;
+
+	connection->preparedQueries.clear();
+	connection->generation = generation;
+
+	if (QThread::currentThread() == QCoreApplication::instance()->thread()) {
+		connection->isDefault = true;
+		return connection;
+	}
+
+	if (!connection->name.isEmpty()) {
+		QSqlDatabase::database(connection->name, false).close();
+		QSqlDatabase::removeDatabase(connection->name);
+	}
+
+	connection->name = QString::number(reinterpret_cast<quintptr>(QThread::currentThread()));
+
+	QSqlDatabase database{QSqlDatabase::addDatabase("QSQLITE", connection->name)};
+
+	database.setDatabaseName(m_databaseName);
+	database.setConnectOptions(m_connectOptions);
+
+	if (database.open())
+		configure(database, m_connectOptions.contains(QLatin1String("QSQLITE_OPEN_READONLY")));
+
+	return connection;
+}
+
+void SqlDatabase::configure(QSqlDatabase& database, bool readOnly) {
+	QSqlQuery query{database};
+
+	// WAL lets the worker connections write without blocking readers, the mode is stored in the file
+	if (!readOnly)
+		query.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
+
+	query.exec(QStringLiteral("PRAGMA synchronous=NORMAL"));
+	query.exec(QStringLiteral("PRAGMA temp_store=MEMORY"));
+	query.exec(QStringLiteral("PRAGMA mmap_size=67108864"));
 }
 
 }
@@ -110,12 +110,20 @@
 //using image = ndb::databases::sielo::images_;
 //}
 
+#include <atomic>
+
 #include <QObject>
 
 #include <QSqlDatabase>
+#include <QSqlQuery>
 
 namespace Sn {
 
+/*
+ * Each thread gets its own connection, QtSql connections can't be shared between
+ * threads. Connections of other threads than the main one are closed when their
+ * thread exits, so the thread pool expiring its threads doesn't leak them.
+ */
 class SIELO_SHAREDLIB SqlDatabase: public QObject {
 	Q_OBJECT
 
@@ -126,11 +134,33 @@ public:
 	QSqlDatabase database() const;
 	void setDatabase(const QSqlDatabase& database);
 
+	/*
+	 * Returns the statement prepared for this SQL text on the calling thread's
+	 * connection, preparing it only the first time. Copies share the statement,
+	 * so bind and execute it right away and call finish() once done reading.
+	 */
+	QSqlQuery preparedQuery(const QString& sql) const;
+
+	// Whether the history_fts full-text index can be queried, only done before the
+	// in-memory HistoryCompletionIndex is loaded
+	bool isHistoryIndexed() const { return m_historyIndexed; }
+	void setHistoryIndexed(bool indexed);
+
 	static SqlDatabase* instance();
 
+	struct Connection;
+
+private slots:
+	void clearPreparedQueries();
+
 private:
+	Connection* localConnection() const;
+	static void configure(QSqlDatabase& database, bool readOnly);
+
 	QString m_databaseName{};
 	QString m_connectOptions{};
+	std::atomic<int> m_generation{0};
+	bool m_historyIndexed{false};
 };
 
 }
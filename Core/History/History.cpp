@@ -25,15 +25,26 @@
 #include "History.hpp"
 
 #include <QSqlQuery>
+#include <QSqlError>
+
+#include <QDebug>
+
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
 
 #include "Utils/Settings.hpp"
 
 #include "Web/WebView.hpp"
 
 #include "History/HistoryModel.hpp"
+#include "History/HistoryCompletionIndex.hpp"
 
 namespace Sn
 {
+static const int VISITS_WRITE_DELAY = 2000;
+static const int MAX_ENTRIES = 1000;
+
 QString History::titleCaseLocalizedMonth(int month)
 {
 	switch (month) {
@@ -68,24 +79,42 @@ QString History::titleCaseLocalizedMonth(int month)
 }
 
 History::History(QObject* parent) :
-	QObject(parent)
+	QObject(parent),
+	m_writeTimer(new QTimer(this)),
+	m_writeWatcher(new QFutureWatcher<QVector<VisitResult>>(this))
 {
+	m_writeTimer->setSingleShot(true);
+	m_writeTimer->setInterval(VISITS_WRITE_DELAY);
+
+	connect(m_writeTimer, &QTimer::timeout, this, &History::writePendingVisits);
+	connect(m_writeWatcher, &QFutureWatcherBase::finished, this, &History::visitsWritten);
+
 	loadSettings();
 }
 
 History::~History()
 {
-	// Empty
+	flushVisits();
 }
 
 HistoryModel *History::model()
 {
-	if (!m_model)
+	if (!m_model) {
+		flushVisits();
 		m_model = new HistoryModel(this);
+	}
 
 	return m_model;
 }
 
+HistoryCompletionIndex* History::completionIndex()
+{
+	if (!m_completionIndex)
+		m_completionIndex = new HistoryCompletionIndex(this);
+
+	return m_completionIndex;
+}
+
 void History::addHistoryEntry(WebView* view)
 {
 	if (!m_isSaving)
@@ -115,55 +144,194 @@ void History::addHistoryEntry(const QUrl& url, QString title)
 	if (title.isEmpty())
 		title = tr("Empty page");
 
-	QSqlQuery query(SqlDatabase::instance()->database());
-	query.prepare("SELECT id, count, date, title FROM history WHERE url=?");
-	query.bindValue(0, url);
-	query.exec();
+	const QString urlString{url.toString()};
+	const qint64 date{QDateTime::currentMSecsSinceEpoch()};
 
-	if (!query.next()) {
-		query.prepare("INSERT INTO history (count, date, url, title) VALUES (1,?,?,?)");
-		query.bindValue(0, QDateTime::currentMSecsSinceEpoch());
-		query.bindValue(1, url);
-		query.bindValue(2, title);
-		query.exec();
+	auto pending = m_pendingVisits.find(urlString);
+	const bool waitingForDatabase{pending != m_pendingVisits.end() && !pending->isKnown};
+
+	// Entries already seen are announced right away, the others once their row is written
+	if (!waitingForDatabase && m_entries.contains(urlString)) {
+		HistoryEntry& entry{m_entries[urlString]};
+		const HistoryEntry before{entry};
 
-		int id = query.lastInsertId().toInt();
-		HistoryEntry entry;
-		entry.id = id;
-		entry.count = 1;
-		entry.date = QDateTime::currentDateTime();
-		entry.url = url;
-		entry.urlString = url.toEncoded();
+		entry.count += 1;
+		entry.date = QDateTime::fromMSecsSinceEpoch(date);
 		entry.title = title;
-		emit historyEntryAdded(entry);
+
+		emit historyEntryEdited(before, entry);
+	}
+
+	if (pending == m_pendingVisits.end()) {
+		Visit visit{};
+		visit.url = url;
+		visit.isKnown = m_entries.contains(urlString);
+
+		pending = m_pendingVisits.insert(urlString, visit);
 	}
-	else {
-		int id = query.value(0).toInt();
-		int count = query.value(1).toInt();
-		QDateTime date = QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
-		QString oldTitle = query.value(3).toString();
-
-		query.prepare("UPDATE history SET count = count + 1, date=?, title=? WHERE url=?");
-		query.bindValue(0, QDateTime::currentMSecsSinceEpoch());
-		query.bindValue(1, title);
-		query.bindValue(2, url);
-		query.exec();
 
-		HistoryEntry before;
-		before.id = id;
-		before.count = count;
-		before.date = date;
-		before.url = url;
-		before.urlString = url.toEncoded();
-		before.title = oldTitle;
+	pending->title = title;
+	pending->date = date;
+	pending->count += 1;
 
-		HistoryEntry after = before;
-		after.count = count + 1;
-		after.date = QDateTime::currentDateTime();
-		after.title = title;
+	if (!m_isWriting && !m_writeTimer->isActive())
+		m_writeTimer->start();
+}
+
+void History::flushVisits()
+{
+	m_writeTimer->stop();
+	waitForRunningWrite();
+
+	if (m_pendingVisits.isEmpty())
+		return;
+
+	const QVector<Visit> visits{m_pendingVisits.values().toVector()};
+	m_pendingVisits.clear();
+
+	applyVisitResults(writeVisits(visits));
+}
+
+void History::writePendingVisits()
+{
+	if (m_isWriting || m_pendingVisits.isEmpty())
+		return;
+
+	const QVector<Visit> visits{m_pendingVisits.values().toVector()};
+	m_pendingVisits.clear();
+
+	m_isWriting = true;
+	m_writeWatcher->setFuture(QtConcurrent::run(&History::writeVisits, visits));
+}
+
+void History::visitsWritten()
+{
+	// The result may already have been applied by waitForRunningWrite()
+	if (!m_isWriting)
+		return;
+
+	m_isWriting = false;
+	applyVisitResults(m_writeWatcher->result());
+
+	if (!m_pendingVisits.isEmpty())
+		m_writeTimer->start();
+}
 
-		emit historyEntryEdited(before, after);
+void History::waitForRunningWrite()
+{
+	if (!m_isWriting)
+		return;
+
+	m_writeWatcher->waitForFinished();
+	visitsWritten();
+	m_writeTimer->stop();
+}
+
+QVector<History::VisitResult> History::writeVisits(const QVector<Visit>& visits)
+{
+	QVector<VisitResult> results{};
+	QSqlDatabase database{SqlDatabase::instance()->database()};
+
+	// One transaction for the whole batch, so only one sync to disk
+	database.transaction();
+
+	QSqlQuery selectQuery{database};
+	selectQuery.prepare("SELECT id, count, date, title FROM history WHERE url=?");
+
+	QSqlQuery upsertQuery{database};
+	upsertQuery.prepare("INSERT INTO history (count, date, url, title) VALUES (?,?,?,?) "
+						"ON CONFLICT(url) DO UPDATE SET count=count+excluded.count, date=excluded.date, "
+						"title=excluded.title");
+
+	foreach (const Visit& visit, visits) {
+		VisitResult result{};
+		result.isNew = true;
+
+		if (!visit.isKnown) {
+			selectQuery.bindValue(0, visit.url);
+			selectQuery.exec();
+
+			if (selectQuery.next()) {
+				result.isNew = false;
+				result.before.id = selectQuery.value(0).toLongLong();
+				result.before.count = selectQuery.value(1).toLongLong();
+				result.before.date = QDateTime::fromMSecsSinceEpoch(selectQuery.value(2).toLongLong());
+				result.before.url = visit.url;
+				result.before.urlString = visit.url.toEncoded();
+				result.before.title = selectQuery.value(3).toString();
+			}
+
+			selectQuery.finish();
+		}
+
+		upsertQuery.bindValue(0, visit.count);
+		upsertQuery.bindValue(1, visit.date);
+		upsertQuery.bindValue(2, visit.url);
+		upsertQuery.bindValue(3, visit.title);
+
+		if (!upsertQuery.exec()) {
+			qWarning() << "History: Unable to record visit of" << visit.url << upsertQuery.lastError().text();
+			continue;
+		}
+
+		if (visit.isKnown)
+			continue;
+
+		result.after = result.before;
+		result.after.count = result.before.count + visit.count;
+		result.after.date = QDateTime::fromMSecsSinceEpoch(visit.date);
+		result.after.title = visit.title;
+
+		if (result.isNew) {
+			result.after.id = upsertQuery.lastInsertId().toLongLong();
+			result.after.url = visit.url;
+			result.after.urlString = visit.url.toEncoded();
+		}
+
+		results.append(result);
+	}
+
+	database.commit();
+
+	return results;
+}
+
+void History::applyVisitResults(const QVector<VisitResult>& results)
+{
+	foreach (const VisitResult& result, results) {
+		m_entries.insert(result.after.url.toString(), result.after);
+
+		if (result.isNew)
+			emit historyEntryAdded(result.after);
+		else
+			emit historyEntryEdited(result.before, result.after);
 	}
+
+	pruneEntries();
+}
+
+void History::pruneEntries()
+{
+	if (m_entries.count() <= MAX_ENTRIES)
+		return;
+
+	// Forget the least recently visited entries, down to three quarters of the limit so this
+	// doesn't run on every write. Entries with a visit waiting to be written must stay, their
+	// next visit is announced from them.
+	QVector<QPair<QDateTime, QString>> entries{};
+	entries.reserve(m_entries.count());
+
+	for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+		if (!m_pendingVisits.contains(it.key()))
+			entries.append(qMakePair(it->date, it.key()));
+	}
+
+	std::sort(entries.begin(), entries.end());
+
+	const int count{qMin(m_entries.count() - MAX_ENTRIES * 3 / 4, entries.count())};
+
+	for (int i{0}; i < count; ++i)
+		m_entries.remove(entries[i].second);
 }
 
 void History::deleteHistoryEntry(int index)
@@ -176,6 +344,8 @@ void History::deleteHistoryEntry(int index)
 
 void History::deleteHistoryEntry(const QList<int>& list)
 {
+	flushVisits();
+
 	QSqlDatabase db = SqlDatabase::instance()->database();
 	db.transaction();
 
@@ -207,6 +377,7 @@ void History::deleteHistoryEntry(const QList<int>& list)
 		query.exec();
 
 		urls.append(entry.url);
+		m_entries.remove(entry.url.toString());
 		emit historyEntryDeleted(entry);
 	}
 
@@ -217,6 +388,8 @@ void History::deleteHistoryEntry(const QList<int>& list)
 
 void History::deleteHistoryEntry(const QString& url, const QString& title)
 {
+	flushVisits();
+
 	QSqlQuery query{SqlDatabase::instance()->database()};
 	query.prepare("SELECT id FROM history WHERE url=? AND title=?");
 	query.bindValue(0, url);
@@ -237,6 +410,8 @@ QList<int> History::indexesFromTimeRange(qint64 start, qint64 end)
 	if (start < 0 || end < 0)
 		return list;
 
+	flushVisits();
+
 	QSqlQuery query{SqlDatabase::instance()->database()};
 	query.prepare("SELECT id FROM history WHERE date BETWEEN ? AND ?");
 	query.addBindValue(end);
@@ -251,18 +426,24 @@ QList<int> History::indexesFromTimeRange(qint64 start, qint64 end)
 
 bool History::urlIsStored(const QString& url)
 {
-	QSqlQuery query{SqlDatabase::instance()->database()};
-	query.prepare("SELECT id FROM history WHERE url=?");
+	flushVisits();
+
+	QSqlQuery query{SqlDatabase::instance()->preparedQuery(QStringLiteral("SELECT id FROM history WHERE url=?"))};
 	query.bindValue(0, url);
 	query.exec();
 
-	return query.next();
+	const bool isStored{query.next()};
+	query.finish();
+
+	return isStored;
 }
 
 QVector<History::HistoryEntry> History::mostVisited(int count)
 {
 	QVector<HistoryEntry> list;
 
+	flushVisits();
+
 	QSqlQuery query{SqlDatabase::instance()->database()};
 	query.prepare(QString("SELECT count, date, id, title, url FROM history ORDER BY count DESC LIMIT %1").arg(count));
 	query.exec();
@@ -282,6 +463,12 @@ QVector<History::HistoryEntry> History::mostVisited(int count)
 
 void History::clearHistory()
 {
+	m_writeTimer->stop();
+	waitForRunningWrite();
+
+	m_pendingVisits.clear();
+	m_entries.clear();
+
 	QSqlQuery query{SqlDatabase::instance()->database()};
 	query.exec("DELETE FROM history");
 	query.exec("VACUUM");
@@ -33,8 +33,12 @@
 #include <QUrl>
 #include <QString>
 #include <QVector>
+#include <QHash>
 #include <QDateTime>
 
+#include <QTimer>
+#include <QFutureWatcher>
+
 #include "Database/SqlDatabase.hpp"
 
 namespace Sn
@@ -42,6 +46,7 @@ namespace Sn
 class WebView;
 
 class HistoryModel;
+class HistoryCompletionIndex;
 
 class SIELO_SHAREDLIB History: public QObject {
 Q_OBJECT
@@ -51,8 +56,8 @@ public:
 	~History();
 
 	struct HistoryEntry {
-		qint64 id;
-		qint64 count;
+		qint64 id{0};
+		qint64 count{0};
 		QDateTime date;
 		QUrl url;
 		QString urlString;
@@ -62,6 +67,7 @@ public:
 	};
 
 	HistoryModel *model();
+	HistoryCompletionIndex* completionIndex();
 
 	void addHistoryEntry(WebView* view);
 	void addHistoryEntry(const QUrl& url, QString title);
@@ -82,6 +88,9 @@ public:
 
 	void loadSettings();
 
+	// Writes the queued visits now, blocking until they are on disk
+	void flushVisits();
+
 	static QString titleCaseLocalizedMonth(int month);
 
 signals:
@@ -91,10 +100,44 @@ signals:
 
 	void resetHistory();
 
+private slots:
+	void writePendingVisits();
+	void visitsWritten();
+
 private:
+	// Visits of the same url are merged until they are written
+	struct Visit {
+		QUrl url{};
+		QString title{};
+		qint64 date{0};
+		qint64 count{0};
+		bool isKnown{false};
+	};
+
+	// State of the entries that weren't known when they were queued
+	struct VisitResult {
+		HistoryEntry before{};
+		HistoryEntry after{};
+		bool isNew{false};
+	};
+
+	static QVector<VisitResult> writeVisits(const QVector<Visit>& visits);
+	void applyVisitResults(const QVector<VisitResult>& results);
+	void pruneEntries();
+	void waitForRunningWrite();
+
 	bool m_isSaving{true};
 
 	HistoryModel* m_model{nullptr};
+	HistoryCompletionIndex* m_completionIndex{nullptr};
+
+	// Recently visited entries, so visits can be announced without querying the database
+	QHash<QString, HistoryEntry> m_entries{};
+	QHash<QString, Visit> m_pendingVisits{};
+
+	QTimer* m_writeTimer{nullptr};
+	QFutureWatcher<QVector<VisitResult>>* m_writeWatcher{nullptr};
+	bool m_isWriting{false};
 };
 }
 
@@ -0,0 +1,443 @@
+﻿/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "HistoryCompletionIndex.hpp"
+
+#include <QSqlQuery>
+
+#include <QDateTime>
+#include <QSet>
+
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+#include "Database/SqlDatabase.hpp"
+
+namespace Sn
+{
+static const qint64 DAY_MSECS = 24 * 60 * 60 * 1000;
+
+HistoryCompletionIndex::HistoryCompletionIndex(History* history) :
+	QObject(history),
+	m_history(history)
+{
+	m_loadWatcher = new QFutureWatcher<Data>(this);
+
+	connect(m_loadWatcher, &QFutureWatcher<Data>::finished, this, &HistoryCompletionIndex::loadFinished);
+
+	connect(m_history, &History::historyEntryAdded, this, &HistoryCompletionIndex::entryAdded);
+	connect(m_history, &History::historyEntryDeleted, this, &HistoryCompletionIndex::entryDeleted);
+	connect(m_history, &History::historyEntryEdited, this, &HistoryCompletionIndex::entryEdited);
+	connect(m_history, &History::resetHistory, this, &HistoryCompletionIndex::historyReset);
+}
+
+HistoryCompletionIndex::~HistoryCompletionIndex()
+{
+	m_loadWatcher->waitForFinished();
+}
+
+void HistoryCompletionIndex::load()
+{
+	if (m_loaded || m_loadWatcher->isRunning())
+		return;
+
+	m_history->flushVisits();
+	m_reloadNeeded = false;
+
+	m_loadWatcher->setFuture(QtConcurrent::run(&HistoryCompletionIndex::loadData));
+}
+
+QVector<HistoryCompletionIndex::Match> HistoryCompletionIndex::complete(const QString& text, int limit)
+{
+	const QString lowerText{text.trimmed().toLower()};
+	const QString address{withoutScheme(lowerText)};
+	const QVector<int> rows{candidates(splitWords(lowerText))};
+	const qint64 now{QDateTime::currentMSecsSinceEpoch()};
+
+	QVector<QPair<double, int>> ranked{};
+	ranked.reserve(rows.size());
+
+	foreach (int row, rows) {
+		const Entry& entry{m_data.entries[row]};
+		double score{frecency(entry, now)};
+
+		// Typing the beginning of an address is a strong hint the user wants this site
+		if (entry.address.startsWith(address)
+			|| (entry.address.startsWith(QLatin1String("www.")) && entry.address.midRef(4).startsWith(address)))
+			score *= 4.0;
+
+		ranked.append(qMakePair(score, row));
+	}
+
+	auto end = ranked.begin() + std::min(limit, ranked.size());
+	std::partial_sort(ranked.begin(), end, ranked.end(), [this](const QPair<double, int>& first, const QPair<double, int>& second)
+	{
+		if (first.first != second.first)
+			return first.first > second.first;
+
+		return m_data.entries[first.second].date > m_data.entries[second.second].date;
+	});
+
+	QVector<Match> matches{};
+
+	for (auto it = ranked.begin(); it != end; ++it) {
+		const Entry& entry{m_data.entries[it->second]};
+		matches.append(Match{entry.id, entry.count, entry.url, entry.title});
+	}
+
+	return matches;
+}
+
+QVector<HistoryCompletionIndex::Match> HistoryCompletionIndex::mostVisited(int limit) const
+{
+	QVector<int> rows{};
+	rows.reserve(m_data.rowsById.size());
+
+	foreach (int row, m_data.rowsById)
+		rows.append(row);
+
+	auto end = rows.begin() + std::min(limit, rows.size());
+	std::partial_sort(rows.begin(), end, rows.end(), [this](int first, int second)
+	{
+		return m_data.entries[first].count > m_data.entries[second].count;
+	});
+
+	QVector<Match> matches{};
+
+	for (auto it = rows.begin(); it != end; ++it) {
+		const Entry& entry{m_data.entries[*it]};
+		matches.append(Match{entry.id, entry.count, entry.url, entry.title});
+	}
+
+	return matches;
+}
+
+QString HistoryCompletionIndex::domainCompletion(const QString& text)
+{
+	const QString lowerText{text.toLower()};
+	const QString address{withoutScheme(lowerText)};
+
+	if (address.isEmpty() || address == QLatin1String("www."))
+		return QString();
+
+	// Addresses starting with the text share its words, so only the candidates need to be checked
+	const bool withoutWww{address.startsWith(QLatin1Char('w')) && !address.startsWith(QLatin1String("www."))};
+	const Entry* best{nullptr};
+
+	foreach (int row, candidates(splitWords(lowerText))) {
+		const Entry& entry{m_data.entries[row]};
+		const bool hasWww{entry.address.startsWith(QLatin1String("www."))};
+
+		if (withoutWww && hasWww)
+			continue;
+
+		if (!entry.address.startsWith(address) && !(hasWww && entry.address.midRef(4).startsWith(address)))
+			continue;
+
+		if (!best || entry.date > best->date)
+			best = &entry;
+	}
+
+	return best ? best->url.host() : QString();
+}
+
+void HistoryCompletionIndex::loadFinished()
+{
+	// The history changed while it was read, the result may already be outdated
+	if (m_reloadNeeded) {
+		m_reloadNeeded = false;
+		m_loadWatcher->setFuture(QtConcurrent::run(&HistoryCompletionIndex::loadData));
+		return;
+	}
+
+	m_data = m_loadWatcher->result();
+	m_loaded = true;
+	clearLastQuery();
+
+	emit loaded();
+}
+
+void HistoryCompletionIndex::entryAdded(const History::HistoryEntry& entry)
+{
+	if (!m_loaded) {
+		m_reloadNeeded = m_reloadNeeded || m_loadWatcher->isRunning();
+		return;
+	}
+
+	if (m_data.rowsById.contains(entry.id)) {
+		entryEdited(entry, entry);
+		return;
+	}
+
+	insertEntry(m_data, createEntry(entry.id, entry.count, entry.date.toMSecsSinceEpoch(), entry.url, entry.title));
+	clearLastQuery();
+}
+
+void HistoryCompletionIndex::entryDeleted(const History::HistoryEntry& entry)
+{
+	if (!m_loaded) {
+		m_reloadNeeded = m_reloadNeeded || m_loadWatcher->isRunning();
+		return;
+	}
+
+	const int row{m_data.rowsById.value(entry.id, -1)};
+
+	if (row < 0)
+		return;
+
+	removeWords(m_data, row);
+	m_data.rowsById.remove(entry.id);
+
+	// Rows are never reused, the removed one is only emptied
+	m_data.entries[row] = Entry{};
+
+	clearLastQuery();
+}
+
+void HistoryCompletionIndex::entryEdited(const History::HistoryEntry& before, const History::HistoryEntry& after)
+{
+	if (!m_loaded) {
+		m_reloadNeeded = m_reloadNeeded || m_loadWatcher->isRunning();
+		return;
+	}
+
+	const int row{m_data.rowsById.value(before.id, -1)};
+
+	if (row < 0) {
+		entryAdded(after);
+		return;
+	}
+
+	Entry& entry{m_data.entries[row]};
+	entry.count = after.count;
+	entry.date = after.date.toMSecsSinceEpoch();
+
+	// Visits only change the ranking, the words are rebuilt when the title or url changes
+	if (entry.title != after.title || entry.url != after.url) {
+		removeWords(m_data, row);
+		entry = createEntry(entry.id, entry.count, entry.date, after.url, after.title);
+		addWords(m_data, row);
+
+		clearLastQuery();
+	}
+}
+
+void HistoryCompletionIndex::historyReset()
+{
+	m_reloadNeeded = m_reloadNeeded || m_loadWatcher->isRunning();
+	m_data = Data{};
+
+	clearLastQuery();
+}
+
+HistoryCompletionIndex::Data HistoryCompletionIndex::loadData()
+{
+	Data data{};
+
+	QSqlQuery query{SqlDatabase::instance()->preparedQuery(QStringLiteral("SELECT id, count, date, url, title FROM history"))};
+	query.exec();
+
+	while (query.next()) {
+		insertEntry(data, createEntry(query.value(0).toLongLong(), query.value(1).toLongLong(),
+		                              query.value(2).toLongLong(), query.value(3).toUrl(), query.value(4).toString()));
+	}
+
+	query.finish();
+
+	return data;
+}
+
+HistoryCompletionIndex::Entry HistoryCompletionIndex::createEntry(qint64 id, qint64 count, qint64 date, const QUrl& url,
+                                                                  const QString& title)
+{
+	Entry entry{};
+	entry.id = id;
+	entry.count = count;
+	entry.date = date;
+	entry.url = url;
+	entry.title = title;
+
+	entry.address = withoutScheme(url.toString().toLower());
+
+	// Query strings are mostly noise and would make the index much bigger. The scheme is
+	// kept as a word so typed or pasted addresses starting with it still match.
+	entry.words = splitWords(url.adjusted(QUrl::RemoveQuery | QUrl::RemoveFragment).toString().toLower())
+		+ splitWords(title.toLower());
+	entry.words.removeDuplicates();
+
+	return entry;
+}
+
+QString HistoryCompletionIndex::withoutScheme(const QString& text)
+{
+	const int schemeEnd{text.indexOf(QLatin1String("://"))};
+
+	return schemeEnd < 0 ? text : text.mid(schemeEnd + 3);
+}
+
+QStringList HistoryCompletionIndex::splitWords(const QString& text)
+{
+	QStringList words{};
+	QString word{};
+
+	foreach (const QChar& c, text) {
+		if (c.isLetterOrNumber())
+			word.append(c);
+		else if (!word.isEmpty()) {
+			words.append(word);
+			word.clear();
+		}
+	}
+
+	if (!word.isEmpty())
+		words.append(word);
+
+	words.removeDuplicates();
+
+	return words;
+}
+
+double HistoryCompletionIndex::frecency(const Entry& entry, qint64 now)
+{
+	const qint64 age{(now - entry.date) / DAY_MSECS};
+	double recency{10.0};
+
+	if (age < 4)
+		recency = 100.0;
+	else if (age < 14)
+		recency = 70.0;
+	else if (age < 31)
+		recency = 50.0;
+	else if (age < 90)
+		recency = 30.0;
+
+	return recency * (1.0 + std::min<qint64>(entry.count, 100));
+}
+
+void HistoryCompletionIndex::insertEntry(Data& data, const Entry& entry)
+{
+	const int row{data.entries.size()};
+
+	data.entries.append(entry);
+	data.rowsById.insert(entry.id, row);
+
+	addWords(data, row);
+}
+
+void HistoryCompletionIndex::addWords(Data& data, int row)
+{
+	foreach (const QString& word, data.entries[row].words)
+		data.words[word].append(row);
+}
+
+void HistoryCompletionIndex::removeWords(Data& data, int row)
+{
+	foreach (const QString& word, data.entries[row].words) {
+		auto it = data.words.find(word);
+
+		if (it == data.words.end())
+			continue;
+
+		it->removeOne(row);
+
+		if (it->isEmpty())
+			data.words.erase(it);
+	}
+}
+
+bool HistoryCompletionIndex::matches(const Entry& entry, const QStringList& terms) const
+{
+	foreach (const QString& term, terms) {
+		bool found{false};
+
+		foreach (const QString& word, entry.words) {
+			if (word.startsWith(term)) {
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+			return false;
+	}
+
+	return true;
+}
+
+QVector<int> HistoryCompletionIndex::candidates(const QStringList& terms)
+{
+	if (terms.isEmpty())
+		return QVector<int>();
+
+	if (terms == m_lastTerms)
+		return m_lastCandidates;
+
+	bool refinesLastQuery{!m_lastTerms.isEmpty() && terms.size() >= m_lastTerms.size()};
+
+	for (int i{0}; refinesLastQuery && i < m_lastTerms.size(); ++i)
+		refinesLastQuery = terms[i].startsWith(m_lastTerms[i]);
+
+	QVector<int> rows{};
+
+	if (refinesLastQuery) {
+		foreach (int row, m_lastCandidates) {
+			if (matches(m_data.entries[row], terms))
+				rows.append(row);
+		}
+	}
+	else {
+		// The longest term is usually the most selective one
+		const QString longest{*std::max_element(terms.begin(), terms.end(), [](const QString& first, const QString& second)
+		{
+			return first.size() < second.size();
+		})};
+
+		QSet<int> seen{};
+
+		for (auto it = m_data.words.lowerBound(longest); it != m_data.words.end() && it.key().startsWith(longest); ++it) {
+			foreach (int row, it.value()) {
+				if (seen.contains(row))
+					continue;
+
+				seen.insert(row);
+
+				if (matches(m_data.entries[row], terms))
+					rows.append(row);
+			}
+		}
+	}
+
+	m_lastTerms = terms;
+	m_lastCandidates = rows;
+
+	return rows;
+}
+
+void HistoryCompletionIndex::clearLastQuery()
+{
+	m_lastTerms.clear();
+	m_lastCandidates.clear();
+}
+}
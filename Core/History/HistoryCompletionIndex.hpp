@@ -0,0 +1,133 @@
+﻿/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_HISTORYCOMPLETIONINDEX_HPP
+#define SIELOBROWSER_HISTORYCOMPLETIONINDEX_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QObject>
+
+#include <QUrl>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+
+#include <QFutureWatcher>
+
+#include "History/History.hpp"
+
+namespace Sn
+{
+/*
+ * In-memory copy of the history used by the address bar completer. Every url and
+ * title is split into lower case words kept in a sorted map, so a prefix lookup is
+ * a range walk. The history is loaded in background on first use and then kept up
+ * to date from the History signals. A query extending the previous one only filters
+ * the previous candidates again.
+ */
+class SIELO_SHAREDLIB HistoryCompletionIndex: public QObject {
+	Q_OBJECT
+
+public:
+	struct Match {
+		qint64 id{0};
+		qint64 count{0};
+		QUrl url{};
+		QString title{};
+	};
+
+	HistoryCompletionIndex(History* history);
+	~HistoryCompletionIndex();
+
+	bool isLoaded() const { return m_loaded; }
+
+	// Starts loading the history in background, does nothing if it is already loaded or loading
+	void load();
+
+	// Entries matching every word of text, best ranked first
+	QVector<Match> complete(const QString& text, int limit);
+	QVector<Match> mostVisited(int limit) const;
+
+	// Host of the most recent entry whose address starts with text, empty if there is none
+	QString domainCompletion(const QString& text);
+
+signals:
+	void loaded();
+
+private slots:
+	void loadFinished();
+
+	void entryAdded(const History::HistoryEntry& entry);
+	void entryDeleted(const History::HistoryEntry& entry);
+	void entryEdited(const History::HistoryEntry& before, const History::HistoryEntry& after);
+	void historyReset();
+
+private:
+	struct Entry {
+		qint64 id{0};
+		qint64 count{0};
+		qint64 date{0};
+		QUrl url{};
+		QString title{};
+		QString address{};
+		QStringList words{};
+	};
+
+	struct Data {
+		QVector<Entry> entries{};
+		QHash<qint64, int> rowsById{};
+		QMap<QString, QVector<int>> words{};
+	};
+
+	static Data loadData();
+	static Entry createEntry(qint64 id, qint64 count, qint64 date, const QUrl& url, const QString& title);
+	static QString withoutScheme(const QString& text);
+	static QStringList splitWords(const QString& text);
+	static double frecency(const Entry& entry, qint64 now);
+
+	static void insertEntry(Data& data, const Entry& entry);
+	static void addWords(Data& data, int row);
+	static void removeWords(Data& data, int row);
+
+	bool matches(const Entry& entry, const QStringList& terms) const;
+	QVector<int> candidates(const QStringList& terms);
+	void clearLastQuery();
+
+	History* m_history{nullptr};
+
+	Data m_data{};
+	bool m_loaded{false};
+	bool m_reloadNeeded{false};
+	QFutureWatcher<Data>* m_loadWatcher{nullptr};
+
+	QStringList m_lastTerms{};
+	QVector<int> m_lastCandidates{};
+};
+}
+
+#endif //SIELOBROWSER_HISTORYCOMPLETIONINDEX_HPP
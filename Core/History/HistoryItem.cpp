@@ -26,6 +26,18 @@
 
 namespace Sn
 {
+HistoryItem::Row HistoryItem::rowFromEntry(const History::HistoryEntry& entry)
+{
+	Row row{};
+	row.id = entry.id;
+	row.count = entry.count;
+	row.date = entry.date.toMSecsSinceEpoch();
+	row.url = entry.url;
+	row.title = entry.title;
+
+	return row;
+}
+
 HistoryItem::HistoryItem(HistoryItem* parent) :
 	canFetchMore(false),
 	m_parent(parent),
@@ -29,6 +29,9 @@
 #include "SharedDefines.hpp"
 
 #include <QList>
+#include <QVector>
+
+#include <QUrl>
 
 #include <QIcon>
 
@@ -36,8 +39,23 @@
 
 namespace Sn
 {
+/*
+ * Root and top level (date range) items of the history model. Visits of a top level
+ * item are plain rows, loaded page after page from the newest one.
+ */
 class SIELO_SHAREDLIB HistoryItem {
 public:
+	struct Row {
+		qint64 id{0};
+		qint64 count{0};
+		qint64 date{0};
+		QUrl url{};
+		QString title{};
+		QIcon icon{};
+	};
+
+	static Row rowFromEntry(const History::HistoryEntry& entry);
+
 	HistoryItem(HistoryItem* parent = nullptr);
 	~HistoryItem();
 
@@ -68,7 +86,7 @@ public:
 	qint64 endTimestamp() const { return m_endTimestamp; }
 	void setEndTimestamp(quint64 end);
 
-	History::HistoryEntry historyEntry{};
+	QVector<Row> rows{};
 	QString title{};
 	bool canFetchMore{false};
 
@@ -71,6 +71,7 @@ HistoryMenu::HistoryMenu(QWidget* parent) :
 	connect(this, &QMenu::aboutToHide, this, &HistoryMenu::aboutToHide);
 	connect(m_menuMostVisited, &QMenu::aboutToShow, this, &HistoryMenu::aboutToShowMostVisited);
 	connect(m_menuClosedTabs, &QMenu::aboutToShow, this, &HistoryMenu::aboutToShowClosedTabs);
+	connect(IconProvider::instance(), &IconProvider::iconLoaded, this, &HistoryMenu::iconLoaded);
 }
 
 HistoryMenu::~HistoryMenu()
@@ -141,7 +142,7 @@ void HistoryMenu::aboutToShow()
 
 		QAction* action{new QAction(title)};
 		action->setData(url);
-		action->setIcon(IconProvider::iconForUrl(url));
+		action->setIcon(IconProvider::requestIconForUrl(url));
 
 		connect(action, &QAction::triggered, this, &HistoryMenu::historyEntryActivated);
 
@@ -169,7 +170,7 @@ void HistoryMenu::aboutToShowMostVisited()
 
 		QAction* action{new QAction(title)};
 		action->setData(entry.url);
-		action->setIcon(IconProvider::iconForUrl(entry.url));
+		action->setIcon(IconProvider::requestIconForUrl(entry.url));
 
 		connect(action, &QAction::triggered, this, &HistoryMenu::historyEntryActivated);
 
@@ -214,6 +215,18 @@ void HistoryMenu::historyEntryActivated()
 	if (QAction* action = qobject_cast<QAction*>(sender()))
 		openUrl(action->data().toUrl());
 }
+
+void HistoryMenu::iconLoaded(const QUrl& url, const QImage& image)
+{
+	const QIcon icon{QPixmap::fromImage(image)};
+
+	foreach(QAction* action, actions() + m_menuMostVisited->actions())
+	{
+		if (action->data().toUrl() == url)
+			action->setIcon(icon);
+	}
+}
+
 void HistoryMenu::openUrl(const QUrl& url)
 {
 	if (m_tabWidget)
@@ -32,6 +32,9 @@
 
 #include <QPointer>
 
+#include <QUrl>
+#include <QImage>
+
 namespace Sn
 {
 class TabWidget;
@@ -59,6 +62,7 @@ private slots:
 	void aboutToShowClosedTabs();
 
 	void historyEntryActivated();
+	void iconLoaded(const QUrl& url, const QImage& image);
 
 	void openUrl(const QUrl& url);
 
@@ -78,13 +78,15 @@ QVariant HistoryModel::headerData(int section, Qt::Orientation orientation, int
 
 QVariant HistoryModel::data(const QModelIndex& index, int role) const
 {
-	HistoryItem* item{itemFromIndex(index)};
-
-	if (index.row() < 0 || !item) {
+	if (!index.isValid())
 		return QVariant();
-	}
 
-	if (item->isTopLevel()) {
+	if (!index.internalPointer()) {
+		HistoryItem* item{topLevelItem(index)};
+
+		if (!item)
+			return QVariant();
+
 		switch (role) {
 		case IsTopLevelRole:
 			return true;
@@ -102,19 +104,22 @@ QVariant HistoryModel::data(const QModelIndex& index, int role) const
 		return QVariant();
 	}
 
-	const History::HistoryEntry entry{item->historyEntry};
+	const HistoryItem::Row* row{rowFromIndex(index)};
+
+	if (!row)
+		return QVariant();
 
 	switch (role) {
 	case IdRole:
-		return entry.id;
+		return row->id;
 	case TitleRole:
-		return entry.title;
+		return row->title;
 	case UrlRole:
-		return entry.url;
+		return row->url;
 	case UrlStringRole:
-		return entry.urlString;
+		return QString::fromUtf8(row->url.toEncoded());
 	case IconRole:
-		return item->icon();
+		return row->icon;
 	case IsTopLevelRole:
 		return false;
 	case TimestampStartRole:
@@ -123,25 +128,25 @@ QVariant HistoryModel::data(const QModelIndex& index, int role) const
 		return -1;
 	case Qt::ToolTipRole:
 		if (index.column() == 0) {
-			return QString("%1\n%2").arg(entry.title, entry.urlString);
+			return QString("%1\n%2").arg(row->title, QString::fromUtf8(row->url.toEncoded()));
 		}
 		// fallthrough
 	case Qt::DisplayRole:
 	case Qt::EditRole:
 		switch (index.column()) {
 		case 0:
-			return entry.title;
+			return row->title;
 		case 1:
-			return entry.urlString;
+			return QString::fromUtf8(row->url.toEncoded());
 		case 2:
-			return dateTimeToString(entry.date);
+			return dateTimeToString(QDateTime::fromMSecsSinceEpoch(row->date));
 		case 3:
-			return entry.count;
+			return row->count;
 		}
 		break;
 	case Qt::DecorationRole:
 		if (index.column() == 0) {
-			return item->icon().isNull() ? Application::getAppIcon("webpage") : item->icon();
+			return row->icon.isNull() ? Application::getAppIcon("webpage") : row->icon;
 		}
 	}
 
@@ -150,13 +155,13 @@ QVariant HistoryModel::data(const QModelIndex& index, int role) const
 
 bool HistoryModel::setData(const QModelIndex& index, const QVariant& value, int role)
 {
-	HistoryItem* item{itemFromIndex(index)};
+	HistoryItem::Row* row{rowFromIndex(index)};
 
-	if (index.row() < 0 || !item || item->isTopLevel())
+	if (!row)
 		return false;
 
 	if (role == IconRole) {
-		item->setIcon(value.value<QIcon>());
+		row->icon = value.value<QIcon>();
 		emit dataChanged(index, index);
 
 		return true;
@@ -170,24 +175,20 @@ QModelIndex HistoryModel::index(int row, int column, const QModelIndex& parent)
 	if (!hasIndex(row, column, parent))
 		return QModelIndex();
 
-	HistoryItem* parentItem{itemFromIndex(parent)};
-	HistoryItem* childItem{parentItem->child(row)};
+	if (!parent.isValid())
+		return createIndex(row, column, nullptr);
 
-	return childItem ? createIndex(row, column, childItem) : QModelIndex();
+	return createIndex(row, column, topLevelItem(parent));
 }
 
 QModelIndex HistoryModel::parent(const QModelIndex& child) const
 {
-	if (!child.isValid())
+	if (!child.isValid() || !child.internalPointer())
 		return QModelIndex();
 
-	HistoryItem* childItem{itemFromIndex(child)};
-	HistoryItem* parentItem{childItem->parent()};
-
-	if (!parentItem || parentItem == m_rootItem)
-		return QModelIndex();
+	HistoryItem* parentItem{static_cast<HistoryItem*>(child.internalPointer())};
 
-	return createIndex(parentItem->row(), 0, parentItem);
+	return createIndex(parentItem->row(), 0, nullptr);
 }
 
 Qt::ItemFlags HistoryModel::flags(const QModelIndex& index) const
@@ -203,8 +204,14 @@ int HistoryModel::rowCount(const QModelIndex& parent) const
 	if (parent.column() > 0)
 		return 0;
 
-	HistoryItem* parentItem{itemFromIndex(parent)};
-	return parentItem->childCount();
+	if (!parent.isValid())
+		return m_rootItem->childCount();
+
+	if (parent.internalPointer())
+		return 0;
+
+	HistoryItem* parentItem{topLevelItem(parent)};
+	return parentItem ? parentItem->rows.count() : 0;
 }
 
 int HistoryModel::columnCount(const QModelIndex& parent) const
@@ -216,56 +223,81 @@ int HistoryModel::columnCount(const QModelIndex& parent) const
 
 bool HistoryModel::canFetchMore(const QModelIndex& parent) const
 {
-	HistoryItem* parentItem{itemFromIndex(parent)};
+	if (!parent.isValid() || parent.internalPointer())
+		return false;
+
+	HistoryItem* parentItem{topLevelItem(parent)};
 
 	return parentItem ? parentItem->canFetchMore : false;
 }
 
 void HistoryModel::fetchMore(const QModelIndex& parent)
 {
-	HistoryItem* parentItem{itemFromIndex(parent)};
-
-	if (!parent.isValid() || !parentItem)
+	if (!parent.isValid() || parent.internalPointer())
 		return;
 
-	parentItem->canFetchMore = false;
+	HistoryItem* parentItem{topLevelItem(parent)};
+
+	if (!parentItem || !parentItem->canFetchMore)
+		return;
 
-	QList<int> idList;
-	for (int i{0}; i < parentItem->childCount(); ++i)
-		idList.append(parentItem->child(i)->historyEntry.id);
+	// Visits already announced may still have their old date in the database, which would
+	// show them a second time at their previous position
+	m_history->flushVisits();
+
+	// Keyset pagination on (date, id) from the last loaded row, rows added since then are
+	// newer and prepended, so they can't come back in a later page
+	QSqlQuery query{};
+
+	if (parentItem->rows.isEmpty()) {
+		query = SqlDatabase::instance()->preparedQuery(QStringLiteral(
+			"SELECT id, count, title, url, date FROM history WHERE date BETWEEN ? AND ? "
+			"ORDER BY date DESC, id DESC LIMIT ?"));
+		query.addBindValue(parentItem->endTimestamp());
+		query.addBindValue(parentItem->startTimestamp());
+		query.addBindValue(PAGE_SIZE);
+	}
+	else {
+		const HistoryItem::Row& last{parentItem->rows.last()};
+
+		query = SqlDatabase::instance()->preparedQuery(QStringLiteral(
+			"SELECT id, count, title, url, date FROM history WHERE date BETWEEN ? AND ? "
+			"AND (date < ? OR (date = ? AND id < ?)) ORDER BY date DESC, id DESC LIMIT ?"));
+		query.addBindValue(parentItem->endTimestamp());
+		query.addBindValue(parentItem->startTimestamp());
+		query.addBindValue(last.date);
+		query.addBindValue(last.date);
+		query.addBindValue(last.id);
+		query.addBindValue(PAGE_SIZE);
+	}
 
-	QSqlQuery query{SqlDatabase::instance()->database()};
-	query.prepare("SELECT id, count, title, url, date FROM history WHERE date BETWEEN ? AND ? ORDER BY date DESC");
-	query.addBindValue(parentItem->endTimestamp());
-	query.addBindValue(parentItem->startTimestamp());
 	query.exec();
 
-	QVector<History::HistoryEntry> list;
+	QVector<HistoryItem::Row> rows{};
+	rows.reserve(PAGE_SIZE);
 
 	while (query.next()) {
-		History::HistoryEntry entry{};
-		entry.id = query.value(0).toInt();
-		entry.count = query.value(1).toInt();
-		entry.title = query.value(2).toString();
-		entry.url = query.value(3).toUrl();
-		entry.date = QDateTime::fromMSecsSinceEpoch(query.value(4).toLongLong());
-		entry.urlString = entry.url.toEncoded();
-
-		if (!idList.contains(entry.id))
-			list.append(entry);
+		HistoryItem::Row row{};
+		row.id = query.value(0).toLongLong();
+		row.count = query.value(1).toLongLong();
+		row.title = query.value(2).toString();
+		row.url = query.value(3).toUrl();
+		row.date = query.value(4).toLongLong();
+
+		rows.append(row);
 	}
 
-	if (list.isEmpty())
-		return;
+	query.finish();
 
-	beginInsertRows(parent, 0, list.size() - 1);
+	parentItem->canFetchMore = rows.count() == PAGE_SIZE;
 
-	foreach(const History::HistoryEntry& entry, list)
-	{
-		HistoryItem* newItem{new HistoryItem(parentItem)};
-		newItem->historyEntry = entry;
-	}
+	if (rows.isEmpty())
+		return;
 
+	const int first{parentItem->rows.count()};
+
+	beginInsertRows(parent, first, first + rows.count() - 1);
+	parentItem->rows.append(rows);
 	endInsertRows();
 }
 
@@ -274,20 +306,31 @@ bool HistoryModel::hasChildren(const QModelIndex& parent) const
 	if (!parent.isValid())
 		return true;
 
-	HistoryItem* item{itemFromIndex(parent)};
-	return item ? item->isTopLevel() : false;
+	return !parent.internalPointer();
 }
 
-HistoryItem *HistoryModel::itemFromIndex(const QModelIndex& index) const
+HistoryItem *HistoryModel::topLevelItem(const QModelIndex& index) const
 {
-	if (index.isValid()) {
-		HistoryItem* item = static_cast<HistoryItem*>(index.internalPointer());
+	if (!index.isValid())
+		return nullptr;
 
-		if (item)
-			return item;
-	}
+	if (index.internalPointer())
+		return static_cast<HistoryItem*>(index.internalPointer());
+
+	return m_rootItem->child(index.row());
+}
+
+HistoryItem::Row *HistoryModel::rowFromIndex(const QModelIndex& index) const
+{
+	if (!index.isValid() || !index.internalPointer())
+		return nullptr;
 
-	return m_rootItem;
+	HistoryItem* parentItem{static_cast<HistoryItem*>(index.internalPointer())};
+
+	if (index.row() < 0 || index.row() >= parentItem->rows.count())
+		return nullptr;
+
+	return &parentItem->rows[index.row()];
 }
 
 void HistoryModel::removeTopLevelIndexes(const QList<QPersistentModelIndex>& indexes)
@@ -333,37 +376,28 @@ void HistoryModel::historyEntryAdded(const History::HistoryEntry& entry)
 		m_todayItem = new HistoryItem();
 		m_todayItem->setStartTimestamp(-1);
 		m_todayItem->setEndTimestamp(QDateTime(QDate::currentDate()).toMSecsSinceEpoch());
-		m_todayItem->title = tr("Title");
+		m_todayItem->title = tr("Today");
 
 		m_rootItem->prependChild(m_todayItem);
 
 		endInsertRows();
 	}
 
-	beginInsertRows(createIndex(0, 0, m_todayItem), 0, 0);
-
-	HistoryItem* item{new HistoryItem()};
-	item->historyEntry = entry;
-
-	m_todayItem->prependChild(item);
-
+	beginInsertRows(createIndex(m_todayItem->row(), 0, nullptr), 0, 0);
+	m_todayItem->rows.prepend(HistoryItem::rowFromEntry(entry));
 	endInsertRows();
 }
 
 void HistoryModel::historyEntryDeleted(const History::HistoryEntry& entry)
 {
-	HistoryItem* item{findHistoryItem(entry)};
+	int row{-1};
+	HistoryItem* parentItem{findHistoryItem(entry, &row)};
 
-	if (!item)
+	if (!parentItem)
 		return;
 
-	HistoryItem* parentItem{item->parent()};
-	int row{item->row()};
-
-	beginRemoveRows(createIndex(parentItem->row(), 0, parentItem), row, row);
-
-	delete item;
-
+	beginRemoveRows(createIndex(parentItem->row(), 0, nullptr), row, row);
+	parentItem->rows.remove(row);
 	endRemoveRows();
 
 	checkEmptyParentItem(parentItem);
@@ -375,7 +409,7 @@ void HistoryModel::historyEntryEdited(const History::HistoryEntry& before, const
 	historyEntryAdded(after);
 }
 
-HistoryItem *HistoryModel::findHistoryItem(const History::HistoryEntry& entry)
+HistoryItem *HistoryModel::findHistoryItem(const History::HistoryEntry& entry, int* row)
 {
 	HistoryItem* parentItem{nullptr};
 	qint64 timestamp = entry.date.toMSecsSinceEpoch();
@@ -392,11 +426,11 @@ HistoryItem *HistoryModel::findHistoryItem(const History::HistoryEntry& entry)
 	if (!parentItem)
 		return nullptr;
 
-	for (int i{0}; i < parentItem->childCount(); ++i) {
-		HistoryItem* item{parentItem->child(i)};
-
-		if (item->historyEntry.id == entry.id)
-			return item;
+	for (int i{0}; i < parentItem->rows.count(); ++i) {
+		if (parentItem->rows[i].id == entry.id) {
+			*row = i;
+			return parentItem;
+		}
 	}
 
 	return nullptr;
@@ -404,7 +438,8 @@ HistoryItem *HistoryModel::findHistoryItem(const History::HistoryEntry& entry)
 
 void HistoryModel::checkEmptyParentItem(HistoryItem* item)
 {
-	if (item->childCount() == 0 && item->isTopLevel()) {
+	// A top level item which isn't fully loaded yet may still have visits
+	if (item->rows.isEmpty() && !item->canFetchMore && item->isTopLevel()) {
 		int row{item->row()};
 
 		beginRemoveRows(QModelIndex(), row, row);
@@ -420,16 +455,6 @@ void HistoryModel::checkEmptyParentItem(HistoryItem* item)
 
 void HistoryModel::init()
 {
-	QSqlQuery query{SqlDatabase::instance()->database()};
-	query.exec("SELECT MIN(date) FROM history");
-
-	if (!query.next())
-		return;
-
-	const qint64 minTimestamp{query.value(0).toLongLong()};
-	if (minTimestamp <= 0)
-		return;
-
 	const QDate today{QDate::currentDate()};
 	const QDate week{today.addDays(1 - today.dayOfWeek())};
 	const QDate month{QDate(today.year(), today.month(), 1)};
@@ -437,48 +462,53 @@ void HistoryModel::init()
 
 	qint64 timestamp{currentTimestamp};
 
-	while (timestamp > minTimestamp) {
-		QDate timestampDate{QDateTime::fromMSecsSinceEpoch(timestamp).date()};
+	// Each query jumps to the newest visit left, so empty ranges cost nothing
+	forever {
+		QSqlQuery query{SqlDatabase::instance()->preparedQuery(QStringLiteral("SELECT MAX(date) FROM history WHERE date <= ?"))};
+		query.addBindValue(timestamp);
+		query.exec();
+
+		const qint64 visitTimestamp{query.next() && !query.value(0).isNull() ? query.value(0).toLongLong() : 0};
+		query.finish();
+
+		if (visitTimestamp <= 0)
+			break;
+
+		QDate visitDate{QDateTime::fromMSecsSinceEpoch(visitTimestamp).date()};
 		qint64 endTimestamp{};
 		QString itemName{};
 
-		if (timestampDate == today) {
+		if (visitDate == today) {
 			endTimestamp = QDateTime(today).toMSecsSinceEpoch();
 			itemName = tr("Today");
 		}
-		else if (timestampDate >= week) {
+		else if (visitDate >= week) {
+			timestamp = qMin(timestamp, QDateTime(today).toMSecsSinceEpoch() - 1);
 			endTimestamp = QDateTime(week).toMSecsSinceEpoch();
 			itemName = tr("This Week");
 		}
-		else if (timestampDate.month() == month.month() && timestampDate.year() == month.year()) {
+		else if (visitDate >= month) {
+			timestamp = qMin(timestamp, QDateTime(week).toMSecsSinceEpoch() - 1);
 			endTimestamp = QDateTime(month).toMSecsSinceEpoch();
 			itemName = tr("This Month");
 		}
 		else {
-			QDate startDate{timestampDate.year(), timestampDate.month(), timestampDate.daysInMonth()};
+			QDate startDate{visitDate.year(), visitDate.month(), visitDate.daysInMonth()};
 			QDate endDate{startDate.year(), startDate.month(), 1};
 
-			timestamp = QDateTime(startDate, QTime(23, 59, 59)).toMSecsSinceEpoch();
+			timestamp = qMin(timestamp, QDateTime(startDate, QTime(23, 59, 59)).toMSecsSinceEpoch());
 			endTimestamp = QDateTime(endDate).toMSecsSinceEpoch();
-			itemName = QString("%1 %2").arg(History::titleCaseLocalizedMonth(timestampDate.month()), QString::number(timestampDate.year()));
+			itemName = QString("%1 %2").arg(History::titleCaseLocalizedMonth(visitDate.month()), QString::number(visitDate.year()));
 		}
 
-		QSqlQuery query{SqlDatabase::instance()->database()};
-		query.prepare("SELECT id FROM history WHERE date BETWEEN ? AND ? LIMIT 1");
-		query.addBindValue(endTimestamp);
-		query.addBindValue(timestamp);
-		query.exec();
-
-		if (query.next()) {
-			HistoryItem* item{new HistoryItem(m_rootItem)};
-			item->setStartTimestamp(timestamp == currentTimestamp ? -1 : timestamp);
-			item->setEndTimestamp(endTimestamp);
-			item->title = itemName;
-			item->canFetchMore = true;
+		HistoryItem* item{new HistoryItem(m_rootItem)};
+		item->setStartTimestamp(visitDate == today ? -1 : timestamp);
+		item->setEndTimestamp(endTimestamp);
+		item->title = itemName;
+		item->canFetchMore = true;
 
-			if (timestamp == currentTimestamp)
-				m_todayItem = item;
-		}
+		if (visitDate == today)
+			m_todayItem = item;
 
 		timestamp = endTimestamp - 1;
 	}
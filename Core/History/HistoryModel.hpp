@@ -34,10 +34,10 @@
 #include <QVariant>
 
 #include "History/History.hpp"
+#include "History/HistoryItem.hpp"
 
 namespace Sn
 {
-class HistoryItem;
 
 class SIELO_SHAREDLIB HistoryModel: public QAbstractItemModel {
 Q_OBJECT
@@ -73,8 +73,6 @@ public:
 
 	bool hasChildren(const QModelIndex& parent) const;
 
-	HistoryItem *itemFromIndex(const QModelIndex& index) const;
-
 	void removeTopLevelIndexes(const QList<QPersistentModelIndex>& indexes);
 
 private slots:
@@ -85,7 +83,13 @@ private slots:
 	void historyEntryEdited(const History::HistoryEntry& before, const History::HistoryEntry& after);
 
 private:
-	HistoryItem *findHistoryItem(const History::HistoryEntry& entry);
+	static const int PAGE_SIZE = 200;
+
+	// Top level indexes have no internal pointer, rows point to their top level item
+	HistoryItem *topLevelItem(const QModelIndex& index) const;
+	HistoryItem::Row *rowFromIndex(const QModelIndex& index) const;
+
+	HistoryItem *findHistoryItem(const History::HistoryEntry& entry, int* row);
 	void checkEmptyParentItem(HistoryItem* item);
 	void init();
 
@@ -45,6 +45,7 @@ HistoryTreeView::HistoryTreeView(QWidget* parent) :
 
 	connect(m_filter, &HistoryFilterModel::expandAllItems, this, &HistoryTreeView::expandAll);
 	connect(m_filter, &HistoryFilterModel::collapseAllItems, this, &HistoryTreeView::collapseAll);
+	connect(IconProvider::instance(), &IconProvider::iconLoaded, this, [this]() { viewport()->update(); });
 }
 
 QUrl HistoryTreeView::selectedUrl() const
@@ -175,9 +176,14 @@ void HistoryTreeView::drawRow(QPainter* painter, const QStyleOptionViewItem& opt
 	bool itemTopLevel{ index.data(HistoryModel::IsTopLevelRole).toBool() };
 	bool iconLoaded{ !index.data(HistoryModel::IconRole).value<QIcon>().isNull() };
 
+	// Icons not cached yet are loaded in background, the row is painted again once it is there
 	if (index.isValid() && !itemTopLevel && !iconLoaded) {
-		const QPersistentModelIndex idx = index;
-		model()->setData(idx, IconProvider::iconForUrl(index.data(HistoryModel::UrlRole).toUrl()), HistoryModel::IconRole);
+		const QImage image{IconProvider::requestImageForUrl(index.data(HistoryModel::UrlRole).toUrl(), true)};
+
+		if (!image.isNull()) {
+			const QPersistentModelIndex idx = index;
+			model()->setData(idx, QIcon(QPixmap::fromImage(image)), HistoryModel::IconRole);
+		}
 	}
 
 	QTreeView::drawRow(painter, options, index);
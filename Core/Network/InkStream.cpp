@@ -0,0 +1,107 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Network/InkStream.hpp"
+
+#include <QDebug>
+
+namespace Sn {
+
+QVector<InkSample> InkStream::decode(const QByteArray& data)
+{
+	QVector<InkSample> samples{};
+
+	const char* it{data.constData()};
+	const char* end{it + data.size()};
+
+	if (it == end || static_cast<quint8>(*it++) != VERSION) {
+		qWarning() << "Unsupported ink stream version";
+		return samples;
+	}
+
+	quint64 time{0};
+
+	if (!readVarint(it, end, time)) {
+		qWarning() << "Truncated ink stream header";
+		return samples;
+	}
+
+	// Samples are at least four bytes long
+	samples.reserve(static_cast<int>((end - it) / 4));
+
+	InkSample sample{};
+	sample.time = static_cast<qint64>(time);
+
+	while (it != end) {
+		quint64 dx{0};
+		quint64 dy{0};
+		quint64 dt{0};
+
+		const int flags{static_cast<quint8>(*it++)};
+
+		if (!readVarint(it, end, dx) || !readVarint(it, end, dy) || it == end) {
+			qWarning() << "Truncated ink stream sample";
+			break;
+		}
+
+		const int pressure{static_cast<quint8>(*it++)};
+
+		if (!readVarint(it, end, dt)) {
+			qWarning() << "Truncated ink stream sample";
+			break;
+		}
+
+		sample.flags = flags;
+		sample.position += QPoint(static_cast<int>(zigzag(dx)), static_cast<int>(zigzag(dy)));
+		sample.pressure = pressure / 255.0;
+		sample.time += static_cast<qint64>(dt);
+
+		samples.append(sample);
+	}
+
+	return samples;
+}
+
+bool InkStream::readVarint(const char*& it, const char* end, quint64& value)
+{
+	value = 0;
+
+	for (int shift{0}; it != end && shift < 64; shift += 7) {
+		const quint8 byte{static_cast<quint8>(*it++)};
+
+		value |= static_cast<quint64>(byte & 0x7f) << shift;
+
+		if (!(byte & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+qint64 InkStream::zigzag(quint64 value)
+{
+	return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+}
+
+}
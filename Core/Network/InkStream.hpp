@@ -0,0 +1,78 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_INKSTREAM_HPP
+#define SIELOBROWSER_INKSTREAM_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QByteArray>
+#include <QPoint>
+#include <QVector>
+
+namespace Sn {
+
+struct SIELO_SHAREDLIB InkSample {
+	enum Flag {
+		Down = 0x1,
+		Up = 0x2
+	};
+
+	QPoint position{};
+	qreal pressure{1.0};
+	qint64 time{0};
+	int flags{0};
+};
+
+/*
+ * Compact pen sample stream, sent as RemoteCommand::Ink payloads so a single
+ * message carries many samples. Positions are in canvas pixels, times are
+ * used to replay the samples at the pace they were captured.
+ *
+ *   quint8  version (1)
+ *   varint  time of the first sample, in milliseconds
+ *   then, for each sample:
+ *     quint8  flags (InkSample::Flag)
+ *     varint  x and y deltas, zigzag encoded, from the previous sample (the
+ *             first sample of a message is relative to 0,0)
+ *     quint8  pressure, from 0 to 255
+ *     varint  milliseconds since the previous sample
+ *
+ * Varints are unsigned LEB128.
+ */
+class SIELO_SHAREDLIB InkStream {
+public:
+	static const quint8 VERSION = 1;
+
+	static QVector<InkSample> decode(const QByteArray& data);
+
+private:
+	static bool readVarint(const char*& it, const char* end, quint64& value);
+	static qint64 zigzag(quint64 value);
+};
+
+}
+
+#endif //SIELOBROWSER_INKSTREAM_HPP
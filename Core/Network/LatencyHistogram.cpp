@@ -0,0 +1,109 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Network/LatencyHistogram.hpp"
+
+#include <QtAlgorithms>
+
+namespace Sn {
+
+void LatencyHistogram::record(qint64 nanoseconds)
+{
+	m_buckets[bucketIndex(static_cast<quint64>(qMax<qint64>(nanoseconds, 0)))].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset()
+{
+	for (std::atomic<quint64>& bucket : m_buckets)
+		bucket.store(0, std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::count() const
+{
+	quint64 total{0};
+
+	for (const std::atomic<quint64>& bucket : m_buckets)
+		total += bucket.load(std::memory_order_relaxed);
+
+	return total;
+}
+
+qint64 LatencyHistogram::percentile(double ratio) const
+{
+	std::array<quint64, BUCKET_COUNT> counts{};
+	quint64 total{0};
+
+	// Work on a copy so a concurrent record() can't make the counts inconsistent
+	for (int i{0}; i < BUCKET_COUNT; ++i) {
+		counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	if (total == 0)
+		return 0;
+
+	const quint64 rank{qMax<quint64>(1, static_cast<quint64>(ratio * static_cast<double>(total) + 0.5))};
+	quint64 seen{0};
+
+	for (int i{0}; i < BUCKET_COUNT; ++i) {
+		seen += counts[i];
+
+		if (seen >= rank)
+			return bucketUpperBound(i);
+	}
+
+	return bucketUpperBound(BUCKET_COUNT - 1);
+}
+
+int LatencyHistogram::bucketIndex(quint64 nanoseconds)
+{
+	if (nanoseconds < (Q_UINT64_C(1) << MIN_BITS))
+		return 0;
+
+	const int highestBit{63 - static_cast<int>(qCountLeadingZeroBits(nanoseconds))};
+	const int octave{highestBit - MIN_BITS};
+
+	if (octave >= OCTAVES)
+		return BUCKET_COUNT - 1;
+
+	const int subBucket{static_cast<int>((nanoseconds >> (highestBit - 2)) & (SUB_BUCKETS - 1))};
+
+	return 1 + octave * SUB_BUCKETS + subBucket;
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+	if (index == 0)
+		return Q_INT64_C(1) << MIN_BITS;
+
+	if (index == BUCKET_COUNT - 1)
+		return Q_INT64_C(1) << (MIN_BITS + OCTAVES);
+
+	const int octave{(index - 1) / SUB_BUCKETS};
+	const int subBucket{(index - 1) % SUB_BUCKETS};
+
+	return static_cast<qint64>(SUB_BUCKETS + subBucket + 1) << (octave + MIN_BITS - 2);
+}
+
+}
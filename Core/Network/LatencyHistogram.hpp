@@ -0,0 +1,67 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_LATENCYHISTOGRAM_HPP
+#define SIELOBROWSER_LATENCYHISTOGRAM_HPP
+
+#include "SharedDefines.hpp"
+
+#include <array>
+#include <atomic>
+
+#include <QtGlobal>
+
+namespace Sn {
+
+/*
+ * Lock-free latency histogram with four buckets per power of two, from 64ns
+ * to about 70ms. Samples can be recorded from any thread, percentiles are
+ * reported as the upper bound of the bucket they fall in.
+ */
+class SIELO_SHAREDLIB LatencyHistogram {
+public:
+	LatencyHistogram() = default;
+
+	void record(qint64 nanoseconds);
+	void reset();
+
+	quint64 count() const;
+	qint64 percentile(double ratio) const;
+
+private:
+	static const int SUB_BUCKETS = 4;
+	static const int MIN_BITS = 6;
+	static const int OCTAVES = 20;
+	static const int BUCKET_COUNT = 2 + OCTAVES * SUB_BUCKETS;
+
+	static int bucketIndex(quint64 nanoseconds);
+	static qint64 bucketUpperBound(int index);
+
+	std::array<std::atomic<quint64>, BUCKET_COUNT> m_buckets{};
+};
+
+}
+
+#endif //SIELOBROWSER_LATENCYHISTOGRAM_HPP
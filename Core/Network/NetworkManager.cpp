@@ -46,6 +46,7 @@
 
 #include "Network/BaseUrlInterceptor.hpp"
 #include "Network/NetworkUrlInterceptor.hpp"
+#include "Network/SieloSchemeHandler.hpp"
 
 namespace Sn {
 
@@ -54,6 +55,8 @@ NetworkManager::NetworkManager(QObject* parent) :
 {
 	m_urlInterceptor = new NetworkUrlInterceptor(this);
 	Application::instance()->webProfile()->setRequestInterceptor(m_urlInterceptor);
+	Application::instance()->webProfile()->installUrlSchemeHandler(QByteArrayLiteral("sielo"),
+																   new SieloSchemeHandler(m_urlInterceptor, this));
 
 	Application::instance()->cookieJar();
 
@@ -26,6 +26,8 @@
 
 #include <QList>
 
+#include <QElapsedTimer>
+
 #include "Utils/Settings.hpp"
 
 #include "Network/BaseUrlInterceptor.hpp"
@@ -34,28 +36,72 @@ namespace Sn {
 
 NetworkUrlInterceptor::NetworkUrlInterceptor(QObject* parent) :
 	Engine::UrlRequestInterceptor(parent),
+	m_pipelineMetrics(std::make_shared<Metrics>()),
 	m_sendDNT(false)
 {
-	// Empty
+	m_pipelineMetrics->name = QStringLiteral("Total");
 }
 
 void NetworkUrlInterceptor::interceptUrlRequest(Engine::UrlRequestInfo& info)
 {
+	QElapsedTimer pipelineTimer{};
+	pipelineTimer.start();
+
 	if (m_sendDNT)
 		info.setHttpHeader(QByteArrayLiteral("DNT"), QByteArrayLiteral("1"));
 
-		foreach (BaseUrlInterceptor* interceptor, m_interceptors) interceptor->interceptRequest(info);
+	QElapsedTimer timer{};
+
+	foreach (const Entry& entry, m_interceptors) {
+		const bool wasBlocked{info.isBlocked()};
+		const bool wasRedirected{info.isRedirected()};
+
+		timer.start();
+		entry.interceptor->interceptRequest(info);
+		entry.metrics->latency.record(timer.nsecsElapsed());
+
+		if (!wasBlocked && info.isBlocked())
+			entry.metrics->blocked.fetch_add(1, std::memory_order_relaxed);
+
+		if (!wasRedirected && info.isRedirected())
+			entry.metrics->redirected.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	m_pipelineMetrics->latency.record(pipelineTimer.nsecsElapsed());
+
+	if (info.isBlocked())
+		m_pipelineMetrics->blocked.fetch_add(1, std::memory_order_relaxed);
+
+	if (info.isRedirected())
+		m_pipelineMetrics->redirected.fetch_add(1, std::memory_order_relaxed);
 }
 
 void NetworkUrlInterceptor::installUrlInterceptor(BaseUrlInterceptor* interceptor)
 {
-	if (!m_interceptors.contains(interceptor))
-		m_interceptors.append(interceptor);
+	foreach (const Entry& entry, m_interceptors) {
+		if (entry.interceptor == interceptor)
+			return;
+	}
+
+	Entry entry{};
+	entry.interceptor = interceptor;
+	entry.metrics = std::make_shared<Metrics>();
+	entry.metrics->name = interceptor->objectName();
+
+	if (entry.metrics->name.isEmpty())
+		entry.metrics->name = QString::fromLatin1(interceptor->metaObject()->className());
+
+	m_interceptors.append(entry);
 }
 
 void NetworkUrlInterceptor::removeUrlInterceptor(BaseUrlInterceptor* interceptor)
 {
-	m_interceptors.removeOne(interceptor);
+	for (int i{0}; i < m_interceptors.count(); ++i) {
+		if (m_interceptors[i].interceptor == interceptor) {
+			m_interceptors.removeAt(i);
+			return;
+		}
+	}
 }
 
 void NetworkUrlInterceptor::loadSettings()
@@ -69,4 +115,42 @@ void NetworkUrlInterceptor::loadSettings()
 	settings.endGroup();
 }
 
+QVector<NetworkUrlInterceptor::Statistics> NetworkUrlInterceptor::statistics() const
+{
+	QVector<Statistics> result{};
+
+	result.append(statistics(*m_pipelineMetrics));
+
+	foreach (const Entry& entry, m_interceptors) result.append(statistics(*entry.metrics));
+
+	return result;
+}
+
+void NetworkUrlInterceptor::resetStatistics()
+{
+	QList<std::shared_ptr<Metrics>> metrics{m_pipelineMetrics};
+
+	foreach (const Entry& entry, m_interceptors) metrics.append(entry.metrics);
+
+	foreach (const std::shared_ptr<Metrics>& metric, metrics) {
+		metric->blocked.store(0, std::memory_order_relaxed);
+		metric->redirected.store(0, std::memory_order_relaxed);
+		metric->latency.reset();
+	}
+}
+
+NetworkUrlInterceptor::Statistics NetworkUrlInterceptor::statistics(const Metrics& metrics)
+{
+	Statistics statistics{};
+
+	statistics.name = metrics.name;
+	statistics.requests = metrics.latency.count();
+	statistics.blocked = metrics.blocked.load(std::memory_order_relaxed);
+	statistics.redirected = metrics.redirected.load(std::memory_order_relaxed);
+	statistics.p50 = metrics.latency.percentile(0.5);
+	statistics.p99 = metrics.latency.percentile(0.99);
+
+	return statistics;
+}
+
 }
\ No newline at end of file
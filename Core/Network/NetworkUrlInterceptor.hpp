@@ -28,16 +28,34 @@
 
 #include "SharedDefines.hpp"
 
+#include <memory>
+#include <atomic>
+
 #include <QObject>
 
+#include <QList>
+#include <QVector>
+
 #include <QWebEngine/UrlRequestInterceptor.hpp>
 #include <QWebEngine/UrlRequestInfo.hpp>
 
+#include "Network/LatencyHistogram.hpp"
+
 namespace Sn {
 class BaseUrlInterceptor;
 
 class SIELO_SHAREDLIB NetworkUrlInterceptor: public Engine::UrlRequestInterceptor {
 public:
+	// Latencies are in nanoseconds
+	struct Statistics {
+		QString name{};
+		quint64 requests{0};
+		quint64 blocked{0};
+		quint64 redirected{0};
+		qint64 p50{0};
+		qint64 p99{0};
+	};
+
 	NetworkUrlInterceptor(QObject* parent = nullptr);
 
 	void interceptUrlRequest(Engine::UrlRequestInfo& info) Q_DECL_OVERRIDE;
@@ -47,8 +65,27 @@ public:
 
 	void loadSettings();
 
+	// The first entry covers the whole pipeline
+	QVector<Statistics> statistics() const;
+	void resetStatistics();
+
 private:
-	QList<BaseUrlInterceptor*> m_interceptors;
+	struct Metrics {
+		QString name{};
+		std::atomic<quint64> blocked{0};
+		std::atomic<quint64> redirected{0};
+		LatencyHistogram latency{};
+	};
+
+	struct Entry {
+		BaseUrlInterceptor* interceptor{nullptr};
+		std::shared_ptr<Metrics> metrics{};
+	};
+
+	static Statistics statistics(const Metrics& metrics);
+
+	QList<Entry> m_interceptors;
+	std::shared_ptr<Metrics> m_pipelineMetrics{};
 	bool m_sendDNT{false};
 };
 }
@@ -0,0 +1,164 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Network/RemoteCommand.hpp"
+
+#include <QDataStream>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+#include <QDebug>
+
+namespace Sn {
+
+QString RemoteCommand::typeToString(int type)
+{
+	switch (type) {
+	case Paint:
+		return QStringLiteral("paint");
+	case Shape:
+		return QStringLiteral("set shape");
+	case Width:
+		return QStringLiteral("set width");
+	case Url:
+		return QStringLiteral("set url");
+	case Ink:
+		return QStringLiteral("ink");
+	case Color:
+		return QStringLiteral("set color");
+	case Clear:
+		return QStringLiteral("clear paint");
+	case Zoom:
+		return QStringLiteral("zoom");
+	default:
+		return QStringLiteral("unknown");
+	}
+}
+
+RemoteCommand RemoteCommand::fromJson(const QJsonObject& object)
+{
+	RemoteCommand command{};
+	command.type = object.value(QLatin1String("type")).toInt();
+
+	const QJsonValue data{object.value(QLatin1String("data"))};
+
+	if (data.isDouble())
+		command.data = QByteArray::number(data.toInt());
+	else
+		command.data = data.toString().toUtf8();
+
+	return command;
+}
+
+QVector<RemoteCommand> RemoteCommand::fromJson(const QByteArray& json)
+{
+	QVector<RemoteCommand> commands{};
+	QJsonParseError error{};
+	const QJsonDocument document{QJsonDocument::fromJson(json, &error)};
+
+	if (error.error != QJsonParseError::NoError) {
+		qWarning() << "Invalid remote command batch:" << error.errorString();
+		return commands;
+	}
+
+	QJsonArray array{};
+
+	if (document.isArray())
+		array = document.array();
+	else if (document.object().contains(QLatin1String("commands")))
+		array = document.object().value(QLatin1String("commands")).toArray();
+	else
+		array.append(document.object());
+
+	commands.reserve(array.count());
+
+	for (const QJsonValue& value : array)
+		commands.append(fromJson(value.toObject()));
+
+	return commands;
+}
+
+QVector<RemoteCommand> RemoteCommand::fromBinary(const QByteArray& data)
+{
+	QVector<RemoteCommand> commands{};
+	QDataStream stream{data};
+
+	while (!stream.atEnd()) {
+		quint8 type{0};
+		RemoteCommand command{};
+
+		stream >> type >> command.data;
+
+		if (stream.status() != QDataStream::Ok) {
+			qWarning() << "Truncated remote command batch";
+			break;
+		}
+
+		command.type = type;
+		commands.append(command);
+	}
+
+	return commands;
+}
+
+bool RemoteCommandQueue::push(const RemoteCommand& command)
+{
+	const quint32 tail{m_tail.load(std::memory_order_relaxed)};
+
+	if (tail - m_head.load(std::memory_order_acquire) >= CAPACITY)
+		return false;
+
+	m_commands[tail % CAPACITY] = command;
+	m_tail.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool RemoteCommandQueue::pop(RemoteCommand& command)
+{
+	const quint32 head{m_head.load(std::memory_order_relaxed)};
+
+	if (head == m_tail.load(std::memory_order_acquire))
+		return false;
+
+	// Release the payload now, the slot may not be reused before a while
+	command = std::move(m_commands[head % CAPACITY]);
+	m_commands[head % CAPACITY] = RemoteCommand();
+	m_head.store(head + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool RemoteCommandQueue::schedule()
+{
+	return !m_scheduled.exchange(true, std::memory_order_acq_rel);
+}
+
+void RemoteCommandQueue::unschedule()
+{
+	m_scheduled.store(false, std::memory_order_release);
+}
+
+}
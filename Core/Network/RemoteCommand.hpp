@@ -0,0 +1,98 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_REMOTECOMMAND_HPP
+#define SIELOBROWSER_REMOTECOMMAND_HPP
+
+#include "SharedDefines.hpp"
+
+#include <array>
+#include <atomic>
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+namespace Sn {
+
+/*
+ * Command sent by the remote controller, through HTTP or the WebSocket
+ * channel. Type values are the ones of the historical "/type=N" endpoint.
+ *
+ * Batches are either JSON (an object, an array of objects, or an object with
+ * a "commands" array, each with "type" and "data") or binary: a sequence of
+ * quint8 type followed by a QDataStream encoded QByteArray.
+ */
+struct SIELO_SHAREDLIB RemoteCommand {
+	enum Type {
+		Paint = 1,
+		Shape = 2,
+		Width = 3,
+		Url = 4,
+		Ink = 5,
+		Color = 6,
+		Clear = 7,
+		Zoom = 8
+	};
+
+	int type{0};
+	QByteArray data{};
+
+	static QString typeToString(int type);
+
+	static RemoteCommand fromJson(const QJsonObject& object);
+	static QVector<RemoteCommand> fromJson(const QByteArray& json);
+	static QVector<RemoteCommand> fromBinary(const QByteArray& data);
+};
+
+/*
+ * Lock-free single producer, single consumer queue. The server thread pushes
+ * commands, the GUI thread drains them. schedule() tells the producer whether
+ * the consumer must be woken up, so a burst of commands costs a single wake up.
+ */
+class SIELO_SHAREDLIB RemoteCommandQueue {
+public:
+	RemoteCommandQueue() = default;
+
+	bool push(const RemoteCommand& command);
+	bool pop(RemoteCommand& command);
+
+	bool schedule();
+	void unschedule();
+
+private:
+	static const quint32 CAPACITY = 1024;
+
+	std::array<RemoteCommand, CAPACITY> m_commands{};
+
+	alignas(64) std::atomic<quint32> m_head{0};
+	alignas(64) std::atomic<quint32> m_tail{0};
+	std::atomic<bool> m_scheduled{false};
+};
+
+}
+
+#endif //SIELOBROWSER_REMOTECOMMAND_HPP
@@ -0,0 +1,110 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Network/SieloSchemeHandler.hpp"
+
+#include <QUrlQuery>
+
+#include "Network/NetworkUrlInterceptor.hpp"
+
+namespace Sn {
+
+static QString formatLatency(qint64 nanoseconds)
+{
+	if (nanoseconds < 1000)
+		return QStringLiteral("%1 ns").arg(nanoseconds);
+
+	if (nanoseconds < 1000 * 1000)
+		return QStringLiteral("%1 us").arg(static_cast<double>(nanoseconds) / 1000.0, 0, 'f', 1);
+
+	return QStringLiteral("%1 ms").arg(static_cast<double>(nanoseconds) / (1000.0 * 1000.0), 0, 'f', 2);
+}
+
+SieloSchemeHandler::SieloSchemeHandler(NetworkUrlInterceptor* interceptor, QObject* parent) :
+	Engine::UrlSchemeHandler(parent),
+	m_interceptor(interceptor)
+{
+	// Empty
+}
+
+void SieloSchemeHandler::urlRequestStarted(Engine::UrlRequestJob& job)
+{
+	const QUrl url{job.requestUrl()};
+	QString page{};
+
+	if (url.path() == QLatin1String("interceptors")) {
+		if (url.query() == QLatin1String("reset"))
+			m_interceptor->resetStatistics();
+
+		page = interceptorsPage();
+	}
+	else if (url.path() == QLatin1String("adblock"))
+		page = adBlockPage(url);
+
+	if (page.isEmpty()) {
+		job.fail(Engine::UrlRequestJob::UrlNotFound);
+		return;
+	}
+
+	job.reply(QByteArrayLiteral("text/html"), page.toUtf8());
+}
+
+QString SieloSchemeHandler::interceptorsPage() const
+{
+	QString rows{};
+
+	foreach (const NetworkUrlInterceptor::Statistics& statistics, m_interceptor->statistics()) {
+		rows += QStringLiteral("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td></tr>")
+			.arg(statistics.name.toHtmlEscaped())
+			.arg(statistics.requests)
+			.arg(statistics.blocked)
+			.arg(statistics.redirected)
+			.arg(formatLatency(statistics.p50))
+			.arg(formatLatency(statistics.p99));
+	}
+
+	return QStringLiteral("<!DOCTYPE html><html><head><meta charset=\"utf-8\"><title>Request interceptors</title>"
+						  "<style>body{font-family:sans-serif;margin:2em}table{border-collapse:collapse}"
+						  "th,td{padding:4px 12px;border-bottom:1px solid #ddd;text-align:right}"
+						  "th:first-child,td:first-child{text-align:left}</style></head><body>"
+						  "<h1>Request interceptors</h1><table><tr><th>Interceptor</th><th>Requests</th>"
+						  "<th>Blocked</th><th>Redirected</th><th>p50</th><th>p99</th></tr>%1</table>"
+						  "<p><a href=\"sielo:interceptors?reset\">Reset</a></p></body></html>").arg(rows);
+}
+
+QString SieloSchemeHandler::adBlockPage(const QUrl& url) const
+{
+	const QUrlQuery query{url};
+	const QString rule{query.queryItemValue(QStringLiteral("rule"), QUrl::FullyDecoded)};
+	const QString subscription{query.queryItemValue(QStringLiteral("subscription"), QUrl::FullyDecoded)};
+
+	return QStringLiteral("<!DOCTYPE html><html><head><meta charset=\"utf-8\"><title>%1</title>"
+						  "<style>body{font-family:sans-serif;margin:2em}code{background:#eee;padding:2px 4px}</style>"
+						  "</head><body><h1>%1</h1><p>%2</p><p><code>%3</code></p></body></html>")
+		.arg(tr("Blocked content"),
+			 tr("This page was blocked by AdBlock, with a rule from the %1 subscription:").arg(subscription.toHtmlEscaped()),
+			 rule.toHtmlEscaped());
+}
+
+}
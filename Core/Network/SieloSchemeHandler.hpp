@@ -0,0 +1,58 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_SIELOSCHEMEHANDLER_HPP
+#define SIELOBROWSER_SIELOSCHEMEHANDLER_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QWebEngine/UrlSchemeHandler.hpp>
+
+namespace Sn {
+class NetworkUrlInterceptor;
+
+/*
+ * Serves the internal sielo: pages.
+ *  - sielo:interceptors shows what the request interceptors cost, add "?reset" to clear the counters
+ *  - sielo:adblock explains why AdBlock blocked a page, ADB::Manager redirects blocked main frames there
+ */
+class SIELO_SHAREDLIB SieloSchemeHandler: public Engine::UrlSchemeHandler {
+Q_OBJECT
+
+public:
+	SieloSchemeHandler(NetworkUrlInterceptor* interceptor, QObject* parent = nullptr);
+
+	void urlRequestStarted(Engine::UrlRequestJob& job) Q_DECL_OVERRIDE;
+
+private:
+	QString interceptorsPage() const;
+	QString adBlockPage(const QUrl& url) const;
+
+	NetworkUrlInterceptor* m_interceptor{nullptr};
+};
+
+}
+
+#endif //SIELOBROWSER_SIELOSCHEMEHANDLER_HPP
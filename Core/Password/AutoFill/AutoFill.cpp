@@ -141,15 +141,18 @@ bool AutoFill::isStoringEnabled(const QUrl& url)
 	if (server.isEmpty())
 		server = url.toString();
 
-	QSqlQuery query{SqlDatabase::instance()->database()};
-	query.prepare("SELECT count(id) FROM autofill_exceptions WHERE server=?");
-	query.addBindValue(server);
+	QSqlQuery query{SqlDatabase::instance()->preparedQuery(
+		QStringLiteral("SELECT count(id) FROM autofill_exceptions WHERE server=?"))};
+	query.bindValue(0, server);
 	query.exec();
 
 	if (!query.next())
 		return false;
 
-	return query.value(0).toInt() <= 0;
+	const bool isStored{query.value(0).toInt() <= 0};
+	query.finish();
+
+	return isStored;
 }
 
 void AutoFill::blockStoringForUrl(const QUrl& url)
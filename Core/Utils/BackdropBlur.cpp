@@ -0,0 +1,209 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Utils/BackdropBlur.hpp"
+
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <QCache>
+#include <QMutex>
+#include <QHash>
+
+namespace Sn {
+
+// Radius the blur runs with once the source is scaled down, bigger radii are reached by scaling
+static const qreal SCALED_RADIUS = 8.0;
+static const int BLUR_PASSES = 3;
+
+// The cache is keyed on a hash only, entries keep their source to rule out collisions
+struct CachedBlur {
+	QImage source{};
+	QSize targetSize{};
+	int radius{0};
+	QImage result{};
+};
+
+static QMutex s_cacheMutex{};
+static QCache<uint, CachedBlur> s_cache{64 * 1024};
+
+// Sliding window average along a line of premultiplied pixels, edges are clamped
+static void blurLine(const QRgb* source, QRgb* destination, int length, int stride, int radius)
+{
+	const int window{2 * radius + 1};
+	int alpha{0};
+	int red{0};
+	int green{0};
+	int blue{0};
+
+	for (int i{-radius}; i <= radius; ++i) {
+		const QRgb pixel{source[qBound(0, i, length - 1) * stride]};
+
+		alpha += qAlpha(pixel);
+		red += qRed(pixel);
+		green += qGreen(pixel);
+		blue += qBlue(pixel);
+	}
+
+	for (int i{0}; i < length; ++i) {
+		destination[i * stride] = qRgba(red / window, green / window, blue / window, alpha / window);
+
+		const QRgb in{source[qMin(i + radius + 1, length - 1) * stride]};
+		const QRgb out{source[qMax(i - radius, 0) * stride]};
+
+		alpha += qAlpha(in) - qAlpha(out);
+		red += qRed(in) - qRed(out);
+		green += qGreen(in) - qGreen(out);
+		blue += qBlue(in) - qBlue(out);
+	}
+}
+
+// Repeated box blurs, horizontal then vertical, get close to a gaussian blur
+static void boxBlur(QImage& image, int radius)
+{
+	if (radius < 1 || image.isNull())
+		return;
+
+	QImage buffer{image.size(), image.format()};
+
+	const int width{image.width()};
+	const int height{image.height()};
+	const int stride{image.bytesPerLine() / static_cast<int>(sizeof(QRgb))};
+
+	for (int pass{0}; pass < BLUR_PASSES; ++pass) {
+		for (int y{0}; y < height; ++y) {
+			blurLine(reinterpret_cast<const QRgb*>(image.constScanLine(y)),
+					 reinterpret_cast<QRgb*>(buffer.scanLine(y)), width, 1, radius);
+		}
+
+		const QRgb* source{reinterpret_cast<const QRgb*>(buffer.constBits())};
+		QRgb* destination{reinterpret_cast<QRgb*>(image.bits())};
+
+		for (int x{0}; x < width; ++x)
+			blurLine(source + x, destination + x, height, stride, radius);
+	}
+}
+
+BackdropBlur::BackdropBlur(QObject* parent) :
+	QObject(parent),
+	m_watcher(new QFutureWatcher<QImage>(this))
+{
+	connect(m_watcher, &QFutureWatcherBase::finished, this, &BackdropBlur::blurFinished);
+}
+
+BackdropBlur::~BackdropBlur()
+{
+	m_watcher->waitForFinished();
+}
+
+void BackdropBlur::blur(const QImage& source, const QSize& targetSize, qreal radius)
+{
+	Request request{};
+	request.source = source;
+	request.targetSize = targetSize;
+	request.radius = radius;
+
+	// Only the latest request matters, older ones waiting are dropped
+	if (m_watcher->isRunning()) {
+		m_pendingRequest = request;
+		m_hasPendingRequest = true;
+		return;
+	}
+
+	start(request);
+}
+
+qreal BackdropBlur::scaleForRadius(qreal radius)
+{
+	if (radius <= SCALED_RADIUS)
+		return 1.0;
+
+	return SCALED_RADIUS / radius;
+}
+
+void BackdropBlur::blurFinished()
+{
+	if (m_hasPendingRequest) {
+		m_hasPendingRequest = false;
+		start(m_pendingRequest);
+		m_pendingRequest = Request();
+		return;
+	}
+
+	emit blurred(m_watcher->result());
+}
+
+void BackdropBlur::start(const Request& request)
+{
+	m_watcher->setFuture(QtConcurrent::run(&BackdropBlur::process, request));
+}
+
+QImage BackdropBlur::process(const Request& request)
+{
+	if (request.source.isNull() || request.targetSize.isEmpty())
+		return QImage();
+
+	const QImage original{request.source.convertToFormat(QImage::Format_ARGB32_Premultiplied)};
+	QImage source{original};
+
+	const int radius{qRound(request.radius)};
+
+	uint key{qHashBits(source.constBits(), static_cast<size_t>(source.sizeInBytes()))};
+	key ^= qHash(request.targetSize.width()) + 0x9e3779b9 + (key << 6) + (key >> 2);
+	key ^= qHash(request.targetSize.height()) + 0x9e3779b9 + (key << 6) + (key >> 2);
+	key ^= qHash(radius) + 0x9e3779b9 + (key << 6) + (key >> 2);
+
+	CachedBlur cached{};
+
+	{
+		QMutexLocker locker{&s_cacheMutex};
+
+		if (CachedBlur* entry = s_cache.object(key))
+			cached = *entry;
+	}
+
+	// Images are shared, the pixels are compared outside of the lock
+	if (cached.targetSize == request.targetSize && cached.radius == radius && cached.source == original)
+		return cached.result;
+
+	const qreal scale{static_cast<qreal>(source.width()) / request.targetSize.width()};
+	boxBlur(source, qRound(request.radius * scale / 2.0));
+
+	QImage result{source.size() == request.targetSize ? source
+		: source.scaled(request.targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)};
+
+	CachedBlur* entry{new CachedBlur};
+	entry->source = original;
+	entry->targetSize = request.targetSize;
+	entry->radius = radius;
+	entry->result = result;
+
+	const qint64 cost{entry->source.sizeInBytes() + result.sizeInBytes()};
+
+	QMutexLocker locker{&s_cacheMutex};
+	s_cache.insert(key, entry, qMax(1, static_cast<int>(cost / 1024)));
+
+	return result;
+}
+
+}
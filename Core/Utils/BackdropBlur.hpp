@@ -0,0 +1,81 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_BACKDROPBLUR_HPP
+#define SIELOBROWSER_BACKDROPBLUR_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QObject>
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QSize>
+
+namespace Sn {
+
+/*
+ * Blurs window backdrops on a worker thread. Sources are expected at reduced
+ * resolution (see scaleForRadius()), the result is scaled back to the target
+ * size. Results are cached by target size, radius and source content, and
+ * shared between windows. Only the latest request is published.
+ */
+class SIELO_SHAREDLIB BackdropBlur: public QObject {
+Q_OBJECT
+
+public:
+	BackdropBlur(QObject* parent = nullptr);
+	~BackdropBlur();
+
+	void blur(const QImage& source, const QSize& targetSize, qreal radius);
+
+	// Factor to scale the source by before blurring it with the given radius
+	static qreal scaleForRadius(qreal radius);
+
+signals:
+	void blurred(const QImage& image);
+
+private slots:
+	void blurFinished();
+
+private:
+	struct Request {
+		QImage source{};
+		QSize targetSize{};
+		qreal radius{0};
+	};
+
+	void start(const Request& request);
+	static QImage process(const Request& request);
+
+	QFutureWatcher<QImage>* m_watcher{nullptr};
+
+	Request m_pendingRequest{};
+	bool m_hasPendingRequest{false};
+};
+
+}
+
+#endif //SIELOBROWSER_BACKDROPBLUR_HPP
@@ -28,6 +28,10 @@
 
 #include <QSqlQuery>
 
+#include <QMutexLocker>
+
+#include <QtConcurrent/QtConcurrentRun>
+
 #include "Database/SqlDatabase.hpp"
 
 #include "Utils/AutoSaver.hpp"
@@ -40,6 +44,19 @@ Q_GLOBAL_STATIC(Sn::IconProvider, sn_icon_provider)
 
 namespace Sn
 {
+static const int ICON_CACHE_SIZE{512};
+
+static QString escapeGlob(QString string)
+{
+	string.replace(QLatin1Char('['), QStringLiteral("[["));
+	string.replace(QLatin1Char(']'), QStringLiteral("[]]"));
+	string.replace(QStringLiteral("[["), QStringLiteral("[[]"));
+	string.replace(QLatin1Char('*'), QStringLiteral("[*]"));
+	string.replace(QLatin1Char('?'), QStringLiteral("[?]"));
+
+	return string;
+}
+
 QByteArray IconProvider::encodeUrl(const QUrl& url)
 {
 	return url.toEncoded(QUrl::RemoveFragment | QUrl::StripTrailingSlash);
@@ -47,14 +64,17 @@ QByteArray IconProvider::encodeUrl(const QUrl& url)
 
 IconProvider::IconProvider() :
 	QObject(),
+	m_urlImages(ICON_CACHE_SIZE),
+	m_domainImages(ICON_CACHE_SIZE),
+	m_lookupWatcher(new QFutureWatcher<LookupResult>(this)),
 	m_autoSaver(new AutoSaver(this))
 {
-	// Empty
+	connect(m_lookupWatcher, &QFutureWatcherBase::finished, this, &IconProvider::lookupFinished);
 }
 
 IconProvider::~IconProvider()
 {
-	// Empty
+	m_lookupWatcher->waitForFinished();
 }
 
 void IconProvider::saveIcon(WebView* view)
@@ -78,20 +98,22 @@ void IconProvider::saveIcon(WebView* view)
 	if (ignoredSchemes.contains(view->url().scheme()))
 		return;
 
-	// We should not save an icon twice
-	for (int i{0}; i < m_iconBuffer.size(); ++i) {
-		if (m_iconBuffer[i].first == view->url()) {
-			m_iconBuffer.removeAt(i);
-			break;
-		}
-	}
-
 	BufferedIcon item{};
 	item.first = view->url();
 	item.second = icon.pixmap(16).toImage();
 
+	const QByteArray encodedUrl{encodeUrl(item.first)};
+
+	QMutexLocker locker{&m_mutex};
+
+	// We should not save an icon twice, the newest one replaces the buffered one
+	m_iconBuffer.insert(encodedUrl, item);
+	m_urlImages.insert(encodedUrl, new QImage(item.second));
+	m_domainImages.insert(item.first.host(), new QImage(item.second));
+
+	locker.unlock();
+
 	m_autoSaver->changeOccurred();
-	m_iconBuffer.append(item);
 }
 
 QIcon IconProvider::iconForUrl(const QUrl& url, bool allowNull)
@@ -102,101 +124,233 @@ QIcon IconProvider::iconForUrl(const QUrl& url, bool allowNull)
 QImage IconProvider::imageForUrl(const QUrl& url, bool allowNull)
 {
 	if (url.path().isEmpty())
-		return allowNull ? QImage() : Application::getAppIcon("webpage").pixmap(16).toImage();
+		return emptyImage(allowNull);
 
-	const QByteArray encodedUrl = encodeUrl(url);
+	const QByteArray encodedUrl{encodeUrl(url)};
+	QImage image{};
 
-	// Check if we aleady have the image loaded in the buffer
-	foreach(const BufferedIcon &ic, instance()->m_iconBuffer)
-	{
-		if (encodeUrl(ic.first) == encodedUrl)
-			return ic.second;
+	if (!instance()->cachedImageForUrl(encodedUrl, &image)) {
+		image = loadImageForUrl(encodedUrl);
+		instance()->cacheImageForUrl(encodedUrl, image);
 	}
 
-	QString urlString{QString::fromUtf8(encodedUrl)};
-	urlString.replace(QLatin1Char('['), QStringLiteral("[["));
-	urlString.replace(QLatin1Char(']'), QStringLiteral("[]]"));
-	urlString.replace(QStringLiteral("[["), QStringLiteral("[[]"));
-	urlString.replace(QLatin1Char('*'), QStringLiteral("[*]"));
-	urlString.replace(QLatin1Char('?'), QStringLiteral("[?]"));
-
-	QSqlQuery query{SqlDatabase::instance()->database()};
-	query.prepare("SELECT icon FROM icons WHERE url GLOB ? LIMIT 1");
-	query.addBindValue(QString("%1*").arg(urlString));
-	query.exec();
-
-	if (query.next())
-		return QImage::fromData(query.value(0).toByteArray());
-
-	return allowNull ? QImage() : Application::getAppIcon("webpage").pixmap(16).toImage();
+	return image.isNull() ? emptyImage(allowNull) : image;
 }
 
 QIcon IconProvider::iconForDomain(const QUrl& url, bool allowNull)
 {
 	return instance()->iconFromImage(imageForDomain(url, allowNull));
 }
+
 QImage IconProvider::imageForDomain(const QUrl& url, bool allowNull)
 {
 	if (url.path().isEmpty())
-		return allowNull ? QImage() : Application::getAppIcon("webpage").pixmap(16).toImage();
+		return emptyImage(allowNull);
+
+	IconProvider* provider{instance()};
+	const QString host{url.host()};
 
-	// Check if we aleady have the image loaded in the buffer
-	foreach(const BufferedIcon &ic, instance()->m_iconBuffer)
 	{
-		if (ic.first.host() == url.host())
-			return ic.second;
+		QMutexLocker locker{&provider->m_mutex};
+
+		if (QImage* image = provider->m_domainImages.object(host))
+			return image->isNull() ? emptyImage(allowNull) : *image;
 	}
 
-	QString urlString{url.host()};
-	urlString.replace(QLatin1Char('['), QStringLiteral("[["));
-	urlString.replace(QLatin1Char(']'), QStringLiteral("[]]"));
-	urlString.replace(QStringLiteral("[["), QStringLiteral("[[]"));
-	urlString.replace(QLatin1Char('*'), QStringLiteral("[*]"));
-	urlString.replace(QLatin1Char('?'), QStringLiteral("[?]"));
+	const QImage image{loadImageForDomain(host)};
 
-	QSqlQuery query{SqlDatabase::instance()->database()};
-	query.prepare("SELECT icon FROM icons WHERE url GLOB ? LIMIT 1");
-	query.addBindValue(QString("*%1*").arg(urlString));
-	query.exec();
+	{
+		QMutexLocker locker{&provider->m_mutex};
+		provider->m_domainImages.insert(host, new QImage(image));
+	}
 
-	if (query.next())
-		return QImage::fromData(query.value(0).toByteArray());
+	return image.isNull() ? emptyImage(allowNull) : image;
+}
 
-	return allowNull ? QImage() : Application::getAppIcon("webpage").pixmap(16).toImage();
+QIcon IconProvider::requestIconForUrl(const QUrl& url, bool allowNull)
+{
+	return instance()->iconFromImage(requestImageForUrl(url, allowNull));
+}
+
+QImage IconProvider::requestImageForUrl(const QUrl& url, bool allowNull)
+{
+	if (url.path().isEmpty())
+		return emptyImage(allowNull);
+
+	IconProvider* provider{instance()};
+	const QByteArray encodedUrl{encodeUrl(url)};
+	QImage image{};
+
+	if (provider->cachedImageForUrl(encodedUrl, &image))
+		return image.isNull() ? emptyImage(allowNull) : image;
+
+	if (!provider->m_lookupUrls.contains(encodedUrl))
+		provider->m_requestedUrls.insert(encodedUrl, url);
+
+	if (!provider->m_lookupPending)
+		provider->startLookup();
+
+	return emptyImage(allowNull);
 }
+
 IconProvider *IconProvider::instance()
 {
 	return sn_icon_provider();
-
 }
+
 void IconProvider::save()
 {
-	foreach(const BufferedIcon &ic, m_iconBuffer)
-	{
+	QMutexLocker locker{&m_mutex};
+	const QHash<QByteArray, BufferedIcon> icons{m_iconBuffer};
+	m_iconBuffer.clear();
+	locker.unlock();
 
-		QSqlQuery query{SqlDatabase::instance()->database()};
-		query.prepare("SELECT id FROM icons WHERE url = ?");
-		query.bindValue(0, encodeUrl(ic.first));
-		query.exec();
+	if (icons.isEmpty())
+		return;
+
+	QSqlDatabase db{SqlDatabase::instance()->database()};
+	db.transaction();
 
-		if (query.next())
-			query.prepare("UPDATE icons SET icon = ? WHERE url = ?");
-		else
-			query.prepare("INSERT INTO icons (icon, url) VALUES (?,?)");
+	for (auto it = icons.constBegin(); it != icons.constEnd(); ++it) {
+		const QString url{QString::fromUtf8(it.key())};
+		const QString host{it.value().first.host()};
 
 		QByteArray ba{};
 		QBuffer buffer(&ba);
 
 		buffer.open(QIODevice::WriteOnly);
-		ic.second.save(&buffer, "PNG");
+		it.value().second.save(&buffer, "PNG");
 
+		QSqlQuery query{SqlDatabase::instance()->preparedQuery(QStringLiteral("UPDATE icons SET icon = ?, host = ? WHERE url = ?"))};
 		query.bindValue(0, buffer.data());
-		query.bindValue(1, QString::fromUtf8(encodeUrl(ic.first)));
+		query.bindValue(1, host);
+		query.bindValue(2, url);
+		query.exec();
+
+		const bool exists{query.numRowsAffected() > 0};
+		query.finish();
+
+		if (exists)
+			continue;
+
+		query = SqlDatabase::instance()->preparedQuery(QStringLiteral("INSERT INTO icons (icon, url, host) VALUES (?,?,?)"));
+		query.bindValue(0, buffer.data());
+		query.bindValue(1, url);
+		query.bindValue(2, host);
 		query.exec();
 	}
 
-	m_iconBuffer.clear();
+	db.commit();
+}
+
+void IconProvider::lookupFinished()
+{
+	const LookupResult result{m_lookupWatcher->result()};
+
+	for (auto it = result.constBegin(); it != result.constEnd(); ++it) {
+		cacheImageForUrl(it.key(), it.value());
+
+		if (!it.value().isNull())
+			emit iconLoaded(m_lookupUrls.value(it.key()), it.value());
+	}
+
+	m_lookupUrls.clear();
+	m_lookupPending = false;
+
+	if (!m_requestedUrls.isEmpty())
+		startLookup();
+}
+
+QImage IconProvider::emptyImage(bool allowNull)
+{
+	return allowNull ? QImage() : Application::getAppIcon("webpage").pixmap(16).toImage();
+}
+
+QImage IconProvider::loadImageForUrl(const QByteArray& encodedUrl)
+{
+	// Prefix GLOB on url can use the iconsUrl index
+	QSqlQuery query{SqlDatabase::instance()->preparedQuery(QStringLiteral("SELECT icon FROM icons WHERE url GLOB ? LIMIT 1"))};
+	query.bindValue(0, QString("%1*").arg(escapeGlob(QString::fromUtf8(encodedUrl))));
+	query.exec();
+
+	QImage image{};
+
+	if (query.next())
+		image = QImage::fromData(query.value(0).toByteArray());
+
+	query.finish();
+
+	return image;
+}
+
+QImage IconProvider::loadImageForDomain(const QString& host)
+{
+	QSqlQuery query{SqlDatabase::instance()->preparedQuery(QStringLiteral("SELECT icon FROM icons WHERE host = ? LIMIT 1"))};
+	query.bindValue(0, host);
+
+	// Read only databases (private browsing) may not have been given the host column yet
+	if (!query.exec()) {
+		query = SqlDatabase::instance()->preparedQuery(QStringLiteral("SELECT icon FROM icons WHERE url GLOB ? LIMIT 1"));
+		query.bindValue(0, QString("*%1*").arg(escapeGlob(host)));
+		query.exec();
+	}
+
+	QImage image{};
+
+	if (query.next())
+		image = QImage::fromData(query.value(0).toByteArray());
+
+	query.finish();
+
+	return image;
+}
+
+IconProvider::LookupResult IconProvider::lookup(const QList<QByteArray>& encodedUrls)
+{
+	LookupResult result{};
+	result.reserve(encodedUrls.count());
+
+	foreach(const QByteArray& encodedUrl, encodedUrls)
+		result.insert(encodedUrl, loadImageForUrl(encodedUrl));
+
+	return result;
 }
+
+bool IconProvider::cachedImageForUrl(const QByteArray& encodedUrl, QImage* image)
+{
+	QMutexLocker locker{&m_mutex};
+
+	if (m_iconBuffer.contains(encodedUrl)) {
+		*image = m_iconBuffer.value(encodedUrl).second;
+		return true;
+	}
+
+	if (QImage* cached = m_urlImages.object(encodedUrl)) {
+		*image = *cached;
+		return true;
+	}
+
+	return false;
+}
+
+void IconProvider::cacheImageForUrl(const QByteArray& encodedUrl, const QImage& image)
+{
+	QMutexLocker locker{&m_mutex};
+	m_urlImages.insert(encodedUrl, new QImage(image));
+}
+
+void IconProvider::startLookup()
+{
+	if (m_requestedUrls.isEmpty())
+		return;
+
+	m_lookupUrls = m_requestedUrls;
+	m_requestedUrls.clear();
+	m_lookupPending = true;
+
+	m_lookupWatcher->setFuture(QtConcurrent::run(&IconProvider::lookup, m_lookupUrls.keys()));
+}
+
 QIcon IconProvider::iconFromImage(const QImage& image)
 {
 	return QIcon(QPixmap::fromImage(image));
@@ -32,6 +32,10 @@
 #include <QImage>
 
 #include <QPair>
+#include <QHash>
+#include <QCache>
+#include <QMutex>
+#include <QFutureWatcher>
 
 #include <QUrl>
 
@@ -42,6 +46,12 @@ class AutoSaver;
 
 class WebView;
 
+/*
+ * Favicons are stored in the icons table, indexed on url and host. Decoded images
+ * are kept in a small LRU cache (misses included) shared by the synchronous lookups,
+ * which may run from worker threads, and the requestIconForUrl() ones which never
+ * touch the database from the GUI thread.
+ */
 class SIELO_SHAREDLIB IconProvider: public QObject {
 	Q_OBJECT
 
@@ -61,15 +71,46 @@ public:
 	static QIcon iconForDomain(const QUrl &url, bool allowNull = false);
 	static QImage imageForDomain(const QUrl &url, bool allowNull = false);
 
+	// Cached icon for url, or a placeholder while it is loaded in background (iconLoaded() is emitted then)
+	static QIcon requestIconForUrl(const QUrl& url, bool allowNull = false);
+	static QImage requestImageForUrl(const QUrl& url, bool allowNull = false);
+
 	static IconProvider* instance();
 
+signals:
+	void iconLoaded(const QUrl& url, const QImage& image);
+
 public slots:
 	void save();
 
+private slots:
+	void lookupFinished();
+
 private:
+	using LookupResult = QHash<QByteArray, QImage>;
+
+	static QImage emptyImage(bool allowNull);
+	static QImage loadImageForUrl(const QByteArray& encodedUrl);
+	static QImage loadImageForDomain(const QString& host);
+	static LookupResult lookup(const QList<QByteArray>& encodedUrls);
+
+	bool cachedImageForUrl(const QByteArray& encodedUrl, QImage* image);
+	void cacheImageForUrl(const QByteArray& encodedUrl, const QImage& image);
+	void startLookup();
+
 	QIcon iconFromImage(const QImage &image);
 
-	QVector<BufferedIcon> m_iconBuffer;
+	QHash<QByteArray, BufferedIcon> m_iconBuffer;
+
+	QMutex m_mutex{};
+	QCache<QByteArray, QImage> m_urlImages;
+	QCache<QString, QImage> m_domainImages;
+
+	QHash<QByteArray, QUrl> m_requestedUrls{};
+	QHash<QByteArray, QUrl> m_lookupUrls{};
+	QFutureWatcher<LookupResult>* m_lookupWatcher{nullptr};
+	// Set until lookupFinished() ran, the watcher stops running before its finished signal is delivered
+	bool m_lookupPending{false};
 
 	AutoSaver* m_autoSaver;
 };
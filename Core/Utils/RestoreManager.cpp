@@ -27,6 +27,7 @@
 
 #include "Utils/RecoveryJsObject.hpp"
 #include "Utils/DataPaths.hpp"
+#include "Utils/SessionJournal.hpp"
 
 #include "Web/WebPage.hpp"
 
@@ -57,6 +58,11 @@ void RestoreManager::createFromFile(const QString& file, RestoreData& data)
 	int version{0};
 	stream >> version;
 
+	if (version == SessionJournal::VERSION) {
+		SessionJournal::replay(stream, data);
+		return;
+	}
+
 	if (version > 1)
 		return;
 
@@ -0,0 +1,416 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Utils/SessionJournal.hpp"
+
+#include <QtConcurrent/QtConcurrent>
+
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+
+#include <QDebug>
+
+#include "Utils/RestoreManager.hpp"
+
+#include "Widgets/Tab/TabWidget.hpp"
+#include "Widgets/Tab/TabsSpaceSplitter.hpp"
+
+#include "BrowserWindow.hpp"
+
+namespace Sn {
+
+// Small journals are never compacted while the session is running
+static const qint64 MIN_COMPACTION_SIZE = 1024 * 1024;
+
+SessionJournal::SessionJournal(const QString& path, QObject* parent) :
+	QObject(parent),
+	m_watcher(new QFutureWatcher<void>(this)),
+	m_storage(std::make_shared<Storage>())
+{
+	m_storage->path = path;
+
+	connect(m_watcher, &QFutureWatcher<void>::finished, this, &SessionJournal::writeFinished);
+}
+
+SessionJournal::~SessionJournal()
+{
+	flush();
+}
+
+void SessionJournal::save(const QList<BrowserWindow*>& windows)
+{
+	Batch batch{};
+	QHash<quint64, TabState> tabs{};
+
+	batch.layout.reserve(windows.count());
+
+	for (BrowserWindow* window : windows) {
+		TabsSpaceSplitter* splitter{window->tabsSpaceSplitter()};
+		WindowLayout windowLayout{};
+
+		windowLayout.windowState = window->isFullScreen() ? QByteArray() : window->saveState();
+		windowLayout.windowGeometry = window->saveGeometry();
+
+		for (int i{0}; i < splitter->count(); ++i) {
+			TabWidget* tabWidget{splitter->tabWidget(i)};
+			const TabsSpaceSplitter::TabsSpaceInfo info{splitter->tabsSpaceInfo(tabWidget)};
+
+			TabsSpaceLayout tabsSpace{};
+			tabsSpace.x = info.x;
+			tabsSpace.y = info.y;
+			tabsSpace.homeUrl = tabWidget->homeUrl().toString();
+
+			for (int j{0}; j < tabWidget->count(); ++j) {
+				WebTab* webTab{tabWidget->webTab(j)};
+
+				if (!webTab)
+					continue;
+
+				TabState state{};
+				state.revision = webTab->sessionRevision();
+				state.parentTab = webTab->parentTab() ? webTab->parentTab()->tabIndex() : -1;
+
+				for (WebTab* child : webTab->childTabs())
+					state.childTabs.append(child->tabIndex());
+
+				const auto known = m_tabs.constFind(webTab->sessionId());
+				const bool hasChanged{
+					webTab->application() || known == m_tabs.constEnd() || known->revision != state.revision
+					|| known->parentTab != state.parentTab || known->childTabs != state.childTabs
+				};
+
+				if (hasChanged) {
+					WebTab::SavedTab tab{webTab};
+
+					if (webTab->application()) {
+						tab.title = "Home Page";
+						tab.url = window->homePageUrl();
+					}
+
+					state.isValid = tab.isValide();
+
+					// Icons are not saved, and must not leave the GUI thread
+					tab.icon = QIcon();
+
+					if (state.isValid)
+						batch.tabs.insert(webTab->sessionId(), tab);
+				}
+				else {
+					state.isValid = known->isValid;
+				}
+
+				tabs.insert(webTab->sessionId(), state);
+
+				if (!state.isValid)
+					continue;
+
+				if (webTab->isCurrentTab())
+					tabsSpace.currentTab = j;
+
+				tabsSpace.tabs.append(webTab->sessionId());
+			}
+
+			if (tabsSpace.currentTab > -1)
+				windowLayout.tabsSpaces.append(tabsSpace);
+		}
+
+		batch.layout.append(windowLayout);
+	}
+
+	m_tabs.swap(tabs);
+
+	if (m_watcher->isRunning()) {
+		for (auto it = batch.tabs.constBegin(); it != batch.tabs.constEnd(); ++it)
+			m_pendingBatch.tabs.insert(it.key(), it.value());
+
+		m_pendingBatch.layout = batch.layout;
+		m_hasPendingBatch = true;
+
+		return;
+	}
+
+	start(batch);
+}
+
+void SessionJournal::flush()
+{
+	m_watcher->waitForFinished();
+
+	if (m_hasPendingBatch) {
+		write(m_storage, m_pendingBatch);
+
+		m_pendingBatch = Batch();
+		m_hasPendingBatch = false;
+	}
+}
+
+bool SessionJournal::replay(QDataStream& stream, RestoreData& data)
+{
+	QHash<quint64, WebTab::SavedTab> tabs{};
+	QVector<WindowLayout> layout{};
+	bool hasLayout{false};
+
+	while (!stream.atEnd()) {
+		quint8 type{0};
+		QByteArray payload{};
+		quint16 checksum{0};
+
+		stream >> type >> payload >> checksum;
+
+		// The last save may have been interrupted, everything before it is still valid
+		if (stream.status() != QDataStream::Ok
+			|| checksum != qChecksum(payload.constData(), static_cast<uint>(payload.size()))) {
+			qWarning() << "Ignoring the end of a torn session journal";
+			break;
+		}
+
+		QDataStream recordStream{payload};
+
+		if (type == TabRecord) {
+			quint64 id{0};
+			WebTab::SavedTab tab{};
+
+			recordStream >> id >> tab;
+			tabs.insert(id, tab);
+		}
+		else if (type == LayoutRecord) {
+			layout.clear();
+			readLayout(recordStream, layout);
+			hasLayout = true;
+		}
+	}
+
+	if (!hasLayout)
+		return false;
+
+	data.windows.clear();
+	data.windows.reserve(layout.count());
+
+	for (const WindowLayout& windowLayout : layout) {
+		BrowserWindow::SavedWindow window{};
+		window.windowState = windowLayout.windowState;
+		window.windowGeometry = windowLayout.windowGeometry;
+
+		for (const TabsSpaceLayout& tabsSpaceLayout : windowLayout.tabsSpaces) {
+			TabsSpaceSplitter::SavedTabsSpace tabsSpace{};
+			tabsSpace.x = tabsSpaceLayout.x;
+			tabsSpace.y = tabsSpaceLayout.y;
+			tabsSpace.currentTab = tabsSpaceLayout.currentTab;
+			tabsSpace.homeUrl = tabsSpaceLayout.homeUrl;
+
+			for (quint64 id : tabsSpaceLayout.tabs) {
+				const auto tab = tabs.constFind(id);
+
+				if (tab != tabs.constEnd())
+					tabsSpace.tabs.append(tab.value());
+			}
+
+			if (tabsSpace.isValid())
+				window.tabsSpaces.append(tabsSpace);
+		}
+
+		data.windows.append(window);
+	}
+
+	return true;
+}
+
+void SessionJournal::writeFinished()
+{
+	if (!m_hasPendingBatch)
+		return;
+
+	const Batch batch{m_pendingBatch};
+
+	m_pendingBatch = Batch();
+	m_hasPendingBatch = false;
+
+	start(batch);
+}
+
+void SessionJournal::start(const Batch& batch)
+{
+	m_watcher->setFuture(QtConcurrent::run(&SessionJournal::write, m_storage, batch));
+}
+
+void SessionJournal::write(std::shared_ptr<Storage> storage, const Batch& batch)
+{
+	QByteArray records{};
+	QSet<quint64> liveTabs{};
+
+	for (auto it = batch.tabs.constBegin(); it != batch.tabs.constEnd(); ++it) {
+		QByteArray payload{};
+		QDataStream stream{&payload, QIODevice::WriteOnly};
+
+		stream << it.key() << it.value();
+
+		const QByteArray tabRecord{record(TabRecord, payload)};
+
+		storage->tabs.insert(it.key(), tabRecord);
+		records += tabRecord;
+	}
+
+	QByteArray payload{};
+	QDataStream stream{&payload, QIODevice::WriteOnly};
+
+	writeLayout(stream, batch.layout);
+
+	storage->layout = record(LayoutRecord, payload);
+	records += storage->layout;
+
+	for (const WindowLayout& window : batch.layout) {
+		for (const TabsSpaceLayout& tabsSpace : window.tabsSpaces) {
+			for (quint64 id : tabsSpace.tabs)
+				liveTabs.insert(id);
+		}
+	}
+
+	// Closed tabs stay in the file until the next compaction
+	qint64 liveSize{storage->layout.size()};
+
+	for (auto it = storage->tabs.begin(); it != storage->tabs.end();) {
+		if (!liveTabs.contains(it.key())) {
+			it = storage->tabs.erase(it);
+		}
+		else {
+			liveSize += it->size();
+			++it;
+		}
+	}
+
+	if (!storage->isCompacted || storage->size + records.size() > qMax(MIN_COMPACTION_SIZE, 2 * liveSize)) {
+		compact(storage.get());
+		return;
+	}
+
+	QFile file{storage->path};
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append)
+		|| file.write(records) != records.size()
+		|| !file.flush()) {
+		qWarning() << "Unable to append to the session journal" << storage->path << file.errorString();
+
+		// The end of the file may be torn, rewrite it entirely next time
+		storage->isCompacted = false;
+		return;
+	}
+
+	storage->size += records.size();
+}
+
+bool SessionJournal::compact(Storage* storage)
+{
+	QByteArray header{};
+	QDataStream stream{&header, QIODevice::WriteOnly};
+
+	stream << VERSION;
+
+	QSaveFile file{storage->path};
+
+	if (!file.open(QIODevice::WriteOnly)) {
+		qWarning() << "Unable to write the session journal" << storage->path << file.errorString();
+		return false;
+	}
+
+	qint64 size{file.write(header)};
+
+	for (const QByteArray& tabRecord : storage->tabs)
+		size += file.write(tabRecord);
+
+	size += file.write(storage->layout);
+
+	if (!file.commit()) {
+		qWarning() << "Unable to write the session journal" << storage->path << file.errorString();
+		storage->isCompacted = false;
+		return false;
+	}
+
+	storage->size = size;
+	storage->isCompacted = true;
+
+	return true;
+}
+
+QByteArray SessionJournal::record(RecordType type, const QByteArray& payload)
+{
+	QByteArray data{};
+	QDataStream stream{&data, QIODevice::WriteOnly};
+
+	stream << static_cast<quint8>(type);
+	stream << payload;
+	stream << qChecksum(payload.constData(), static_cast<uint>(payload.size()));
+
+	return data;
+}
+
+void SessionJournal::writeLayout(QDataStream& stream, const QVector<WindowLayout>& layout)
+{
+	stream << layout.count();
+
+	for (const WindowLayout& window : layout) {
+		stream << window.windowState;
+		stream << window.windowGeometry;
+		stream << window.tabsSpaces.count();
+
+		for (const TabsSpaceLayout& tabsSpace : window.tabsSpaces) {
+			stream << tabsSpace.x;
+			stream << tabsSpace.y;
+			stream << tabsSpace.currentTab;
+			stream << tabsSpace.homeUrl;
+			stream << tabsSpace.tabs;
+		}
+	}
+}
+
+void SessionJournal::readLayout(QDataStream& stream, QVector<WindowLayout>& layout)
+{
+	int windowCount{0};
+	stream >> windowCount;
+
+	for (int i{0}; i < windowCount && stream.status() == QDataStream::Ok; ++i) {
+		WindowLayout window{};
+		int tabsSpaceCount{0};
+
+		stream >> window.windowState;
+		stream >> window.windowGeometry;
+		stream >> tabsSpaceCount;
+
+		for (int j{0}; j < tabsSpaceCount && stream.status() == QDataStream::Ok; ++j) {
+			TabsSpaceLayout tabsSpace{};
+
+			stream >> tabsSpace.x;
+			stream >> tabsSpace.y;
+			stream >> tabsSpace.currentTab;
+			stream >> tabsSpace.homeUrl;
+			stream >> tabsSpace.tabs;
+
+			window.tabsSpaces.append(tabsSpace);
+		}
+
+		layout.append(window);
+	}
+}
+
+}
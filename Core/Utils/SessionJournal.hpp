@@ -0,0 +1,139 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_SESSIONJOURNAL_HPP
+#define SIELOBROWSER_SESSIONJOURNAL_HPP
+
+#include "SharedDefines.hpp"
+
+#include <memory>
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "Web/Tab/WebTab.hpp"
+
+namespace Sn {
+class BrowserWindow;
+
+struct RestoreData;
+
+/*
+ * Append-only session file. Each save appends the tabs that changed since the
+ * last one, then the layout of the windows referencing tabs by id. Writes are
+ * done on a worker thread. When the journal grows over twice the size of the
+ * live session, it is compacted through a QSaveFile, so the file on disk is
+ * always either the old or the new one. A torn record at the end of the file
+ * is ignored when the journal is replayed.
+ */
+class SIELO_SHAREDLIB SessionJournal: public QObject {
+Q_OBJECT
+
+public:
+	static const int VERSION = 2;
+
+	SessionJournal(const QString& path, QObject* parent = nullptr);
+	~SessionJournal();
+
+	void save(const QList<BrowserWindow*>& windows);
+
+	// Wait for the writes in flight and write the pending ones
+	void flush();
+
+	// The version has already been read from the stream
+	static bool replay(QDataStream& stream, RestoreData& data);
+
+private slots:
+	void writeFinished();
+
+private:
+	enum RecordType {
+		TabRecord = 1,
+		LayoutRecord = 2
+	};
+
+	struct TabsSpaceLayout {
+		int x{0};
+		int y{0};
+		int currentTab{-1};
+		QString homeUrl{};
+		QVector<quint64> tabs{};
+	};
+
+	struct WindowLayout {
+		QByteArray windowState{};
+		QByteArray windowGeometry{};
+		QVector<TabsSpaceLayout> tabsSpaces{};
+	};
+
+	struct TabState {
+		quint64 revision{0};
+		int parentTab{-1};
+		QVector<int> childTabs{};
+		bool isValid{false};
+	};
+
+	struct Batch {
+		QHash<quint64, WebTab::SavedTab> tabs{};
+		QVector<WindowLayout> layout{};
+	};
+
+	// Only used by the write in flight
+	struct Storage {
+		QString path{};
+		QHash<quint64, QByteArray> tabs{};
+		QByteArray layout{};
+		qint64 size{0};
+		bool isCompacted{false};
+	};
+
+	void start(const Batch& batch);
+
+	static void write(std::shared_ptr<Storage> storage, const Batch& batch);
+	static bool compact(Storage* storage);
+
+	static QByteArray record(RecordType type, const QByteArray& payload);
+	static void writeLayout(QDataStream& stream, const QVector<WindowLayout>& layout);
+	static void readLayout(QDataStream& stream, QVector<WindowLayout>& layout);
+
+	QFutureWatcher<void>* m_watcher{nullptr};
+	std::shared_ptr<Storage> m_storage{};
+
+	QHash<quint64, TabState> m_tabs{};
+
+	Batch m_pendingBatch{};
+	bool m_hasPendingBatch{false};
+};
+
+}
+
+#endif //SIELOBROWSER_SESSIONJOURNAL_HPP
@@ -26,6 +26,8 @@
 
 namespace Sn {
 QSettings* Settings::s_settings = nullptr;
+std::shared_ptr<const SettingsSnapshot> Settings::s_snapshot{};
+std::atomic<bool> Settings::s_snapshotDirty{true};
 
 Settings::Settings()
 {
@@ -47,6 +49,7 @@ Settings::~Settings()
 void Settings::createSettings(const QString& fileName)
 {
 	s_settings = new QSettings(fileName, QSettings::IniFormat);
+	s_snapshotDirty = true;
 }
 
 void Settings::syncSettings()
@@ -57,6 +60,35 @@ void Settings::syncSettings()
 	s_settings->sync();
 }
 
+std::shared_ptr<const SettingsSnapshot> Settings::snapshot()
+{
+	if (s_snapshotDirty.exchange(false))
+		std::atomic_store(&s_snapshot, loadSnapshot());
+
+	return std::atomic_load(&s_snapshot);
+}
+
+std::shared_ptr<const SettingsSnapshot> Settings::loadSnapshot()
+{
+	std::shared_ptr<SettingsSnapshot> snapshot{std::make_shared<SettingsSnapshot>()};
+
+	if (!s_settings)
+		return snapshot;
+
+	Settings settings{};
+
+	settings.beginGroup("Web-Settings");
+
+	snapshot->defaultZoomLevel = settings.value("defaultZoomLevel", snapshot->defaultZoomLevel).toInt();
+	snapshot->loadTabsOnActivation = settings.value("LoadTabsOnActivation", true).toBool();
+	snapshot->maximumConcurrentRestores = qMax(1, settings.value("maximumConcurrentRestores", 2).toInt());
+	snapshot->tabsMemoryBudget = settings.value("tabsMemoryBudget", 0).toLongLong() * 1024 * 1024;
+
+	settings.endGroup();
+
+	return snapshot;
+}
+
 bool Settings::contains(const QString& key)
 {
 	return s_settings->contains(key);
@@ -65,11 +97,13 @@ bool Settings::contains(const QString& key)
 void Settings::remove(const QString& key)
 {
 	s_settings->remove(key);
+	s_snapshotDirty = true;
 }
 
 void Settings::setValue(const QString& key, const QVariant& defaultValue)
 {
 	s_settings->setValue(key, defaultValue);
+	s_snapshotDirty = true;
 }
 
 QVariant Settings::value(const QString& key, const QVariant& defaultValue)
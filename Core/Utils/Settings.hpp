@@ -30,8 +30,22 @@
 
 #include <QSettings>
 
+#include <atomic>
+#include <memory>
+
 namespace Sn
 {
+/*
+ * Typed copy of the settings read while creating tabs and views. It is built
+ * once and rebuilt on the next access after any setValue() or remove().
+ */
+struct SIELO_SHAREDLIB SettingsSnapshot {
+	int defaultZoomLevel{8};	// 100% in WebView::zoomLevels()
+	bool loadTabsOnActivation{true};
+	int maximumConcurrentRestores{2};
+	qint64 tabsMemoryBudget{0};
+};
+
 class SIELO_SHAREDLIB Settings {
 public:
 	Settings();
@@ -40,6 +54,8 @@ public:
 	static void createSettings(const QString& fileName);
 	static void syncSettings();
 
+	static std::shared_ptr<const SettingsSnapshot> snapshot();
+
 	bool contains(const QString& key);
 	void remove(const QString& key);
 
@@ -52,7 +68,11 @@ public:
 	void sync();
 
 private:
+	static std::shared_ptr<const SettingsSnapshot> loadSnapshot();
+
 	static QSettings* s_settings;
+	static std::shared_ptr<const SettingsSnapshot> s_snapshot;
+	static std::atomic<bool> s_snapshotDirty;
 
 	QString m_openedGroup{};
 };
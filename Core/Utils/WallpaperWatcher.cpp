@@ -0,0 +1,185 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Utils/WallpaperWatcher.hpp"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+#include "Utils/DelayedFileWatcher.hpp"
+#include "Utils/Settings.hpp"
+
+Q_GLOBAL_STATIC(Sn::WallpaperWatcher, sn_wallpaper_watcher)
+
+namespace Sn {
+
+WallpaperWatcher::WallpaperWatcher(QObject* parent) :
+	QObject(parent),
+	m_watcher(new DelayedFileWatcher(this))
+{
+	connect(m_watcher, &DelayedFileWatcher::delayedFileChanged, this, &WallpaperWatcher::fileChanged);
+	connect(m_watcher, &DelayedFileWatcher::delayedDirectoryChanged, this, &WallpaperWatcher::directoryChanged);
+}
+
+WallpaperWatcher::~WallpaperWatcher()
+{
+	// Empty
+}
+
+WallpaperWatcher* WallpaperWatcher::instance()
+{
+	return sn_wallpaper_watcher();
+}
+
+void WallpaperWatcher::reload()
+{
+	const QString path{wallpaperPath()};
+
+	if (path != m_path) {
+		m_path = path;
+		m_image = QImage();
+		m_lastModified = QDateTime();
+		m_size = -1;
+		m_hash.clear();
+
+		watch(m_path);
+		update();
+
+		emit wallpaperChanged(m_path, m_image);
+	}
+	else {
+		if (!m_path.isEmpty() && !m_watcher->files().contains(QFileInfo(m_path).absoluteFilePath()))
+			watch(m_path);
+
+		if (update())
+			emit wallpaperChanged(m_path, m_image);
+	}
+}
+
+void WallpaperWatcher::fileChanged(const QString& path)
+{
+	if (m_path.isEmpty() || QFileInfo(path).absoluteFilePath() != QFileInfo(m_path).absoluteFilePath())
+		return;
+
+	// Editors and tools often replace the file, which drops it from the watcher
+	const QString filePath{QFileInfo(m_path).absoluteFilePath()};
+	if (!m_watcher->files().contains(filePath) && QFileInfo::exists(filePath))
+		m_watcher->addPath(filePath);
+
+	if (update())
+		emit wallpaperChanged(m_path, m_image);
+}
+
+void WallpaperWatcher::directoryChanged(const QString& path)
+{
+	Q_UNUSED(path);
+
+	fileChanged(m_path);
+}
+
+QString WallpaperWatcher::wallpaperPath()
+{
+	Settings settings{};
+
+	QString backgroundPath{settings.value(QLatin1String("Settings/backgroundPath"), QString()).toString()};
+
+#ifdef Q_OS_WIN
+	if (backgroundPath.isEmpty()) {
+		QSettings wallpaperSettings{"HKEY_CURRENT_USER\\Control Panel\\Desktop", QSettings::NativeFormat};
+		backgroundPath = wallpaperSettings.value("WallPaper", QString()).toString();
+		backgroundPath.replace("\\", "/");
+	}
+#endif
+
+	return backgroundPath;
+}
+
+void WallpaperWatcher::watch(const QString& path)
+{
+	if (!m_watcher->files().isEmpty())
+		m_watcher->removePaths(m_watcher->files());
+	if (!m_watcher->directories().isEmpty())
+		m_watcher->removePaths(m_watcher->directories());
+
+	if (path.isEmpty())
+		return;
+
+	const QFileInfo info{path};
+
+	if (info.exists())
+		m_watcher->addPath(info.absoluteFilePath());
+	if (info.absoluteDir().exists())
+		m_watcher->addPath(info.absolutePath());
+}
+
+bool WallpaperWatcher::update()
+{
+	if (m_path.isEmpty())
+		return false;
+
+	const QFileInfo info{m_path};
+
+	if (!info.exists()) {
+		if (m_image.isNull() && m_hash.isEmpty())
+			return false;
+
+		m_image = QImage();
+		m_lastModified = QDateTime();
+		m_size = -1;
+		m_hash.clear();
+
+		return true;
+	}
+
+	if (info.lastModified() == m_lastModified && info.size() == m_size)
+		return false;
+
+	m_lastModified = info.lastModified();
+	m_size = info.size();
+
+	QFile file{m_path};
+
+	if (!file.open(QIODevice::ReadOnly)) {
+		qWarning() << "Unable to read wallpaper" << m_path << file.errorString();
+		return false;
+	}
+
+	const QByteArray data{file.readAll()};
+	const QByteArray hash{QCryptographicHash::hash(data, QCryptographicHash::Sha1)};
+
+	// Touched, or rewritten with the same content
+	if (hash == m_hash)
+		return false;
+
+	m_hash = hash;
+	m_image = QImage::fromData(data);
+
+	return true;
+}
+
+}
@@ -0,0 +1,87 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_WALLPAPERWATCHER_HPP
+#define SIELOBROWSER_WALLPAPERWATCHER_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QObject>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QImage>
+#include <QString>
+
+namespace Sn {
+class DelayedFileWatcher;
+
+/*
+ * Tracks the wallpaper used behind browser windows. The file and its parent
+ * directory are watched, so changes are picked up without polling. The image
+ * is decoded once, only when the file really changed (modification time or
+ * size first, then a hash of its content), and shared between all windows.
+ */
+class SIELO_SHAREDLIB WallpaperWatcher: public QObject {
+Q_OBJECT
+
+public:
+	WallpaperWatcher(QObject* parent = nullptr);
+	~WallpaperWatcher();
+
+	static WallpaperWatcher* instance();
+
+	QString path() const { return m_path; }
+	QImage image() const { return m_image; }
+
+public slots:
+	// Read the wallpaper path again from the settings (and the system on Windows)
+	void reload();
+
+signals:
+	void wallpaperChanged(const QString& path, const QImage& image);
+
+private slots:
+	void fileChanged(const QString& path);
+	void directoryChanged(const QString& path);
+
+private:
+	static QString wallpaperPath();
+
+	void watch(const QString& path);
+	bool update();
+
+	DelayedFileWatcher* m_watcher{nullptr};
+
+	QString m_path{};
+	QImage m_image{};
+	QDateTime m_lastModified{};
+	qint64 m_size{-1};
+	QByteArray m_hash{};
+};
+
+}
+
+#endif //SIELOBROWSER_WALLPAPERWATCHER_HPP
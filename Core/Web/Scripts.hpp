@@ -214,6 +214,58 @@ public:
 		return source;
 	}
 
+	// Style sheet added as soon as the document is created, before anything is painted
+	static QString elementHiding(const QString& css, const QString& id)
+	{
+		QString source = QLatin1String("(function() {"
+			"var schemes = ['file:', 'qrc:', 'sielo:', 'data:', 'adb:'];"
+			"if (window._sielo_element_hiding_disabled || schemes.indexOf(window.location.protocol) != -1)"
+			"    return;"
+			""
+			"var style = document.createElement('style');"
+			"style.id = '%1';"
+			"style.textContent = '%2';"
+			""
+			"function insertStyle() {"
+			"    (document.head || document.documentElement).appendChild(style);"
+			"}"
+			""
+			"if (document.documentElement) {"
+			"    insertStyle();"
+			"    return;"
+			"}"
+			""
+			"var observer = new MutationObserver(function() {"
+			"    if (!document.documentElement)"
+			"        return;"
+			"    observer.disconnect();"
+			"    insertStyle();"
+			"});"
+			"observer.observe(document, { childList: true });"
+			""
+			"})()");
+
+		QString style{css};
+		style.replace(QLatin1String("\\"), QLatin1String("\\\\"));
+		style.replace(QLatin1String("'"), QLatin1String("\\'"));
+		style.replace(QLatin1String("\n"), QLatin1String("\\n"));
+
+		return source.arg(id, style);
+	}
+
+	// Removes the style sheet of elementHiding(), whichever of the two scripts runs first
+	static QString disableElementHiding(const QString& id)
+	{
+		QString source = QLatin1String("(function() {"
+			"window._sielo_element_hiding_disabled = true;"
+			"var style = document.getElementById('%1');"
+			"if (style)"
+			"    style.parentNode.removeChild(style);"
+			"})()");
+
+		return source.arg(id);
+	}
+
 };
 }
 
@@ -0,0 +1,181 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Web/Tab/TabLifecycleManager.hpp"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QMultiHash>
+
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#include "Utils/Settings.hpp"
+
+#include "Web/Tab/WebTab.hpp"
+
+#include "Widgets/Tab/TabWidget.hpp"
+#include "Widgets/Tab/TabsSpaceSplitter.hpp"
+
+#include "Application.hpp"
+#include "BrowserWindow.hpp"
+
+namespace Sn
+{
+static const int CHECK_INTERVAL = 15 * 1000;
+
+#ifdef Q_OS_LINUX
+static qint64 processResidentPages(const QString& pid)
+{
+	QFile file{QLatin1String("/proc/") + pid + QLatin1String("/statm")};
+
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+
+	// size resident shared text lib data dt
+	const QList<QByteArray> fields{file.readAll().split(' ')};
+
+	return fields.count() > 1 ? fields[1].toLongLong() : -1;
+}
+
+static qint64 parentPid(const QString& pid)
+{
+	QFile file{QLatin1String("/proc/") + pid + QLatin1String("/stat")};
+
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+
+	// pid (comm) state ppid ..., comm may contain spaces
+	const QByteArray stat{file.readAll()};
+	const QList<QByteArray> fields{stat.mid(stat.lastIndexOf(')') + 2).split(' ')};
+
+	return fields.count() > 1 ? fields[1].toLongLong() : -1;
+}
+#endif
+
+TabLifecycleManager::TabLifecycleManager(QObject* parent) :
+	QObject(parent),
+	m_timer(new QTimer(this))
+{
+	m_timer->setInterval(CHECK_INTERVAL);
+
+	connect(m_timer, &QTimer::timeout, this, &TabLifecycleManager::checkMemory);
+}
+
+TabLifecycleManager::~TabLifecycleManager()
+{
+	// Empty
+}
+
+void TabLifecycleManager::loadSettings()
+{
+	m_budget = Settings::snapshot()->tabsMemoryBudget;
+
+	if (m_budget > 0 && residentMemory() >= 0)
+		m_timer->start();
+	else
+		m_timer->stop();
+}
+
+qint64 TabLifecycleManager::residentMemory()
+{
+#ifdef Q_OS_LINUX
+	const qint64 pageSize{sysconf(_SC_PAGESIZE)};
+	const QString self{QString::number(QCoreApplication::applicationPid())};
+
+	qint64 pages{processResidentPages(self)};
+
+	if (pages < 0)
+		return -1;
+
+	// Renderers are forked by the QtWebEngine zygote, so the whole process tree is counted
+	const QStringList processes{QDir(QLatin1String("/proc")).entryList(QDir::Dirs | QDir::NoDotAndDotDot)};
+	QMultiHash<qint64, QString> children{};
+
+	for (const QString& pid : processes) {
+		if (pid.at(0).isDigit())
+			children.insert(parentPid(pid), pid);
+	}
+
+	QStringList descendants{children.values(QCoreApplication::applicationPid())};
+
+	while (!descendants.isEmpty()) {
+		const QString pid{descendants.takeLast()};
+
+		pages += qMax(0ll, processResidentPages(pid));
+		descendants.append(children.values(pid.toLongLong()));
+	}
+
+	return pages * pageSize;
+#else
+	return -1;
+#endif
+}
+
+void TabLifecycleManager::checkMemory()
+{
+	const qint64 memory{residentMemory()};
+
+	if (memory < 0 || memory <= m_budget)
+		return;
+
+	// The memory of a discarded tab is only released once its page is gone, one tab per check
+	WebTab* tab{discardCandidate()};
+
+	if (!tab)
+		return;
+
+	qWarning() << "Memory budget exceeded (" << memory / (1024 * 1024) << "MiB ), discarding" << tab->url();
+
+	tab->discard();
+}
+
+WebTab* TabLifecycleManager::discardCandidate() const
+{
+	WebTab* candidate{nullptr};
+
+	for (BrowserWindow* window : Application::instance()->windows()) {
+		for (TabWidget* tabWidget : window->tabsSpaceSplitter()->tabWidgets()) {
+			for (int i{0}; i < tabWidget->count(); ++i) {
+				WebTab* tab{tabWidget->webTab(i)};
+
+				if (!tab || tab->isCurrentTab() || tab->isPinned() || tab->application())
+					continue;
+
+				if (!tab->isRestored() || tab->url().isEmpty() || tab->isPlaying() || tab->isLoading())
+					continue;
+
+				if (!candidate || tab->lastActivated() < candidate->lastActivated())
+					candidate = tab;
+			}
+		}
+	}
+
+	return candidate;
+}
+}
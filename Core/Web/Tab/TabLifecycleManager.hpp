@@ -0,0 +1,68 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_TABLIFECYCLEMANAGER_HPP
+#define SIELOBROWSER_TABLIFECYCLEMANAGER_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QObject>
+
+#include <QTimer>
+
+namespace Sn
+{
+class WebTab;
+
+/*
+ * Discards background tabs when the browser uses more memory than allowed by
+ * Web-Settings/tabsMemoryBudget (in MiB, 0 disables it). The least recently
+ * activated tab that is loaded, not current, not pinned and not playing audio
+ * is unloaded at each check, it reloads when it is activated again.
+ */
+class SIELO_SHAREDLIB TabLifecycleManager: public QObject {
+	Q_OBJECT
+
+public:
+	TabLifecycleManager(QObject* parent = nullptr);
+	~TabLifecycleManager();
+
+	void loadSettings();
+
+	// Resident memory of the browser and its web processes, -1 if unknown
+	static qint64 residentMemory();
+
+private slots:
+	void checkMemory();
+
+private:
+	WebTab* discardCandidate() const;
+
+	QTimer* m_timer{nullptr};
+	qint64 m_budget{0};
+};
+}
+
+#endif //SIELOBROWSER_TABLIFECYCLEMANAGER_HPP
@@ -0,0 +1,113 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "Web/Tab/TabRestoreScheduler.hpp"
+
+#include <QTimer>
+
+#include "Utils/Settings.hpp"
+
+#include "Web/Tab/WebTab.hpp"
+
+namespace Sn
+{
+// Time after which a tab that is still loading stops holding a slot
+static const int LOAD_TIMEOUT = 15 * 1000;
+
+TabRestoreScheduler::TabRestoreScheduler(QObject* parent) :
+	QObject(parent)
+{
+	loadSettings();
+}
+
+TabRestoreScheduler::~TabRestoreScheduler()
+{
+	// Empty
+}
+
+void TabRestoreScheduler::loadSettings()
+{
+	m_maximumLoads = Settings::snapshot()->maximumConcurrentRestores;
+
+	startNext();
+}
+
+void TabRestoreScheduler::schedule(WebTab* tab)
+{
+	if (!tab || tab->isRestored())
+		return;
+
+	m_queue.enqueue(tab);
+
+	// Let the window show up with its placeholders before loading anything
+	QTimer::singleShot(0, this, &TabRestoreScheduler::startNext);
+}
+
+void TabRestoreScheduler::startNext()
+{
+	m_loading.removeAll(QPointer<WebTab>());
+
+	while (m_loading.count() < m_maximumLoads && !m_queue.isEmpty()) {
+		QPointer<WebTab> tab{m_queue.dequeue()};
+
+		// Closed, or already loaded because the user activated it
+		if (!tab || tab->isRestored())
+			continue;
+
+		m_loading.append(tab);
+
+		connect(tab.data(), &WebTab::loadingChanged, this, [this, tab](bool loading)
+		{
+			if (!loading)
+				finish(tab);
+		});
+		connect(tab.data(), &QObject::destroyed, this, &TabRestoreScheduler::startNext);
+
+		QTimer::singleShot(LOAD_TIMEOUT, this, [this, tab]()
+		{
+			finish(tab);
+		});
+
+		tab->loadSavedTab();
+	}
+}
+
+void TabRestoreScheduler::finish(WebTab* tab)
+{
+	if (!tab) {
+		startNext();
+		return;
+	}
+
+	const int index{m_loading.indexOf(tab)};
+
+	if (index < 0)
+		return;
+
+	m_loading.removeAt(index);
+	disconnect(tab, nullptr, this, nullptr);
+
+	startNext();
+}
+}
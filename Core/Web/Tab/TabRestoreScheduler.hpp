@@ -0,0 +1,71 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#pragma once
+#ifndef SIELOBROWSER_TABRESTORESCHEDULER_HPP
+#define SIELOBROWSER_TABRESTORESCHEDULER_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QObject>
+
+#include <QList>
+#include <QPointer>
+#include <QQueue>
+
+namespace Sn
+{
+class WebTab;
+
+/*
+ * Loads restored background tabs a few at a time. Restored tabs stay
+ * placeholders (title and icon from the saved session) until they are
+ * activated or their turn comes. A tab is considered loaded when its page
+ * finished loading, or after a timeout so a slow page can't stall the queue.
+ */
+class SIELO_SHAREDLIB TabRestoreScheduler: public QObject {
+	Q_OBJECT
+
+public:
+	TabRestoreScheduler(QObject* parent = nullptr);
+	~TabRestoreScheduler();
+
+	void loadSettings();
+
+	void schedule(WebTab* tab);
+
+	int maximumLoads() const { return m_maximumLoads; }
+
+private:
+	void startNext();
+	void finish(WebTab* tab);
+
+	QQueue<QPointer<WebTab>> m_queue{};
+	QList<QPointer<WebTab>> m_loading{};
+
+	int m_maximumLoads{2};
+};
+}
+
+#endif //SIELOBROWSER_TABRESTORESCHEDULER_HPP
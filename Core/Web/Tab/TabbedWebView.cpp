@@ -27,6 +27,7 @@
 #include <QStatusBar>
 
 #include <QMimeData>
+#include <QPointer>
 
 #include "BrowserWindow.hpp"
 
@@ -222,23 +223,29 @@ void TabbedWebView::inspectElement()
 
 void TabbedWebView::newContextMenuEvent(QContextMenuEvent* event)
 {
-	m_menu->clear();
+	const QPoint pos{event->globalPos()};
+	QPointer<TabbedWebView> view{this};
 
-	WebHitTestResult hitTest{page()->hitTestContent(event->pos())};
- 	createContextMenu(m_menu, hitTest);
-// 	m_menu->addSeparator();
-// 	m_menu->addAction(Application::getAppIcon("text-html"), tr("Show so&urce code"), this, &WebView::showSource);
-// 	m_menu->addAction(tr("Inspect Element"), this, &TabbedWebView::inspectElement);
+	// The menu is shown once the page answered, the GUI thread doesn't wait for it
+	page()->hitTestContent(event->pos(), [view, pos](const WebHitTestResult& result)
+	{
+		if (!view)
+			return;
 
-	if (!m_menu->isEmpty()) {
-		const QPoint pos{event->globalPos()};
-		QPoint p{pos.x(), pos.y() + 1};
+		WebHitTestResult hitTest{result};
 
-		m_menu->popup(p);
-		return;
-	}
+		view->m_menu->clear();
+		view->createContextMenu(view->m_menu, hitTest);
+// 		view->m_menu->addSeparator();
+// 		view->m_menu->addAction(Application::getAppIcon("text-html"), tr("Show so&urce code"), view, &WebView::showSource);
+// 		view->m_menu->addAction(tr("Inspect Element"), view, &TabbedWebView::inspectElement);
 
-	WebView::newContextMenuEvent(event);
+		if (!view->m_menu->isEmpty()) {
+			QPoint p{pos.x(), pos.y() + 1};
+
+			view->m_menu->popup(p);
+		}
+	});
 }
 
 void TabbedWebView::newMousePressEvent(QMouseEvent* event)
@@ -25,6 +25,7 @@
 #include "Web/Tab/WebTab.hpp"
 
 #include <QColor>
+#include <QDateTime>
 #include <QLineEdit>
 
 #include "BrowserWindow.hpp"
@@ -34,6 +35,7 @@
 #include "Plugins/PluginProxy.hpp"
 
 #include "Web/WebPage.hpp"
+#include "Web/Tab/TabRestoreScheduler.hpp"
 #include "Web/Tab/TabbedWebView.hpp"
 
 #include "Widgets/FloatingButton.hpp"
@@ -48,6 +50,7 @@ namespace Sn
 
 static const int SAVED_TAB_VERSION = 2;
 static WebTab::AddChildBehavior s_addChildBehavior = WebTab::AppendChild;
+static quint64 s_lastSessionId = 0;
 
 WebTab::AddChildBehavior WebTab::addChildBehavior()
 {
@@ -62,10 +65,7 @@ void WebTab::setAddChildBehavior(AddChildBehavior behavior)
 WebTab::SavedTab::SavedTab() :
 	isPinned(false)
 {
-	Settings settings{};
-	int defaultZoomLevel{settings.value("Web-Settings/defaultZoomLevel", WebView::zoomLevels().indexOf(100)).toInt()};
-
-	zoomLevel = defaultZoomLevel;
+	zoomLevel = Settings::snapshot()->defaultZoomLevel;
 }
 
 WebTab::SavedTab::SavedTab(WebTab* webTab)
@@ -94,15 +94,12 @@ bool WebTab::SavedTab::isValide() const
 
 void WebTab::SavedTab::clear()
 {
-	Settings settings{};
-	int defaultZoomLevel{settings.value("Web-Settings/defaultZoomLevel", WebView::zoomLevels().indexOf(100)).toInt()};
-
 	title.clear();
 	url.clear();
 	icon = QIcon();
 	history.clear();
 	isPinned = false;
-	zoomLevel = defaultZoomLevel;
+	zoomLevel = Settings::snapshot()->defaultZoomLevel;
 	parentTab = -1;
 	childTabs.clear();
 	sessionData.clear();
@@ -169,6 +166,8 @@ WebTab::WebTab(TabWidget* tabWidget) :
 	m_isPinned(false)
 {
 	setObjectName(QLatin1String("webtab"));
+	m_sessionId = ++s_lastSessionId;
+	m_lastActivated = QDateTime::currentMSecsSinceEpoch();
 	//setStyleSheet("#webtab {background-color: white;}");
 
 	m_layout = new QVBoxLayout(this);
@@ -219,6 +218,18 @@ WebTab::WebTab(TabWidget* tabWidget) :
 
 	pageChanged(m_webView->page());
 
+	auto sessionChanged = [this]()
+	{
+		++m_sessionRevision;
+	};
+
+	connect(m_webView, &TabbedWebView::urlChanged, this, sessionChanged);
+	connect(m_webView, &TabbedWebView::titleChanged, this, sessionChanged);
+	connect(m_webView, &TabbedWebView::loadFinished, this, sessionChanged);
+	connect(m_webView, &TabbedWebView::zoomLevelChanged, this, sessionChanged);
+	connect(this, &WebTab::restoredChanged, this, sessionChanged);
+	connect(this, &WebTab::pinnedChanged, this, sessionChanged);
+
 	connect(m_webView, &TabbedWebView::pageChanged, this, pageChanged);
 
 	connect(m_tabIcon, &TabIcon::resized, this, [this]()
@@ -332,6 +343,7 @@ void WebTab::addChildTab(WebTab* tab, int index)
 void WebTab::setSessionData(const QString& key, const QVariant& value)
 {
 	m_sessionData[key] = value;
+	++m_sessionRevision;
 }
 
 QUrl WebTab::url() const
@@ -502,13 +514,18 @@ void WebTab::loadApplication(QWidget* application)
 }
 
 void WebTab::unload()
+{
+	discard();
+	m_webView->setFocus();
+}
+
+void WebTab::discard()
 {
 	m_savedTab = SavedTab(this);
-	
+
 	emit restoredChanged(isRestored());
 
 	m_webView->setPage(new WebPage());
-	m_webView->setFocus();
 }
 
 bool WebTab::isLoading() const
@@ -640,12 +657,13 @@ void WebTab::restoreTab(const SavedTab& tab)
 {
 	Q_ASSERT(m_tabWidget->tabBar());
 
-	Settings settings{};
-
 	m_isPinned = tab.isPinned;
 	m_sessionData = tab.sessionData;
+	++m_sessionRevision;
 
-	if (!isPinned() && settings.value("Web-Settings/LoadTabsOnActivation", true).toBool()) {
+	// Every restored tab starts as a placeholder, the page is only created on activation
+	// or when the restore scheduler gets to it
+	if (tab.isValide()) {
 		m_savedTab = tab;
 
 		emit restoredChanged(isRestored());
@@ -666,12 +684,9 @@ void WebTab::restoreTab(const SavedTab& tab)
 			m_tabWidget->tabBar()->overrideTabTextColor(index, newColor);
 
 		}
-	}
-	else {
-		QTimer::singleShot(1000, this, [=]()
-		{
-			p_restoreTab(tab);
-		});
+
+		if (isPinned() || !Settings::snapshot()->loadTabsOnActivation)
+			Application::instance()->tabRestoreScheduler()->schedule(this);
 	}
 }
 
@@ -694,6 +709,13 @@ void WebTab::p_restoreTab(const QUrl& url, const QByteArray& history, int zoomLe
 }
 
 void WebTab::tabActivated()
+{
+	m_lastActivated = QDateTime::currentMSecsSinceEpoch();
+
+	loadSavedTab();
+}
+
+void WebTab::loadSavedTab()
 {
 	if (isRestored() || m_application)
 		return;
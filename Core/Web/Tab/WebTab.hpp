@@ -113,6 +113,10 @@ public:
 	QHash<QString, QVariant> sessionData() const { return m_sessionData; }
 	void setSessionData(const QString& key, const QVariant& value);
 
+	// Used by the session journal to serialize only the tabs that changed
+	quint64 sessionId() const { return m_sessionId; }
+	quint64 sessionRevision() const { return m_sessionRevision; }
+
 	QUrl url() const;
 	QString title() const;
 	QIcon icon(bool allowNull = false) const;
@@ -134,6 +138,8 @@ public:
 	void load(const LoadRequest& request);
 	void loadApplication(QWidget* application);
 	void unload();
+	// Same as unload() without touching the focus, for tabs discarded in background
+	void discard();
 	bool isLoading() const;
 
 	bool isPinned() const;
@@ -150,6 +156,7 @@ public:
 	int tabIndex() const;
 
 	bool isCurrentTab() const { return m_isCurrentTab; }
+	qint64 lastActivated() const { return m_lastActivated; }
 	void makeCurrentTab() const;
 	void closeTab() const;
 	void moveTab(int to) const;
@@ -166,6 +173,8 @@ public:
 	void p_restoreTab(const QUrl& url, const QByteArray& history, int zoomLevel);
 
 	void tabActivated();
+	// Loads the page of a placeholder tab without marking it as used, for background restores
+	void loadSavedTab();
 
 	static AddChildBehavior addChildBehavior();
 	static void setAddChildBehavior(AddChildBehavior behavior);
@@ -222,6 +231,10 @@ private:
 	SavedTab m_savedTab{};
 	bool m_isPinned{false};
 	bool m_isCurrentTab{false};
+
+	quint64 m_sessionId{0};
+	quint64 m_sessionRevision{0};
+	qint64 m_lastActivated{0};
 };
 }
 #endif //SIELOBROWSER_WEBTAB_HPP
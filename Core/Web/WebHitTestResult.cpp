@@ -24,19 +24,46 @@
 
 #include "Web/WebHitTestResult.hpp"
 
-#include <QWebEngine/WebProfile.hpp>
-
-#include "Web/WebPage.hpp"
-
 namespace Sn {
 
-WebHitTestResult::WebHitTestResult(const WebPage* page, const QPoint& pos) :
+WebHitTestResult::WebHitTestResult(const QPoint& pos, const QPointF& viewportPos, const QUrl& url, const QVariantMap& map) :
 	m_isNull(true),
 	m_isContentEditable(false),
 	m_isContentSelected(false),
 	m_mediaPaused(false),
 	m_mediaMuted(false),
-	m_pos(pos)
+	m_pos(pos),
+	m_viewportPos(viewportPos)
+{
+	if (map.isEmpty())
+		return;
+
+	m_isNull = false;
+	m_baseUrl = map.value(QStringLiteral("baseUrl")).toUrl();
+	m_alternateText = map.value(QStringLiteral("alternateText")).toString();
+	m_imageUrl = map.value(QStringLiteral("imageUrl")).toUrl();
+	m_isContentEditable = map.value(QStringLiteral("contentEditable")).toBool();
+	m_isContentSelected = map.value(QStringLiteral("contentSelected")).toBool();
+	m_linkTitle = map.value(QStringLiteral("linkTitle")).toString();
+	m_linkUrl = map.value(QStringLiteral("linkUrl")).toUrl();
+	m_mediaUrl = map.value(QStringLiteral("mediaUrl")).toUrl();
+	m_mediaPaused = map.value(QStringLiteral("mediaPaused")).toBool();
+	m_mediaMuted = map.value(QStringLiteral("mediaMuted")).toBool();
+	m_tagName = map.value(QStringLiteral("tagName")).toString();
+
+	const QVariantList& rect = map.value(QStringLiteral("boundingRect")).toList();
+	if (rect.size() == 4)
+		m_boundingRect = QRect(rect.at(0).toInt(), rect.at(1).toInt(), rect.at(2).toInt(), rect.at(3).toInt());
+
+	if (!m_imageUrl.isEmpty())
+		m_imageUrl = url.resolved(m_imageUrl);
+	if (!m_linkUrl.isEmpty())
+		m_linkUrl = m_baseUrl.resolved(m_linkUrl);
+	if (!m_mediaUrl.isEmpty())
+		m_mediaUrl = url.resolved(m_mediaUrl);
+}
+
+QString WebHitTestResult::script(const QPointF& viewportPos)
 {
 	QString source = QLatin1String("(function() {"
 									   "var e = document.elementFromPoint(%1, %2);"
@@ -79,11 +106,11 @@ WebHitTestResult::WebHitTestResult(const WebPage* page, const QPoint& pos) :
 									   "    res.linkUrl = e.getAttribute('href');"
 									   "}"
 									   "while (e) {"
-									   "    if (res.linkTitle == ''& & e.tagName == 'A')"
+									   "    if (res.linkTitle == '' && e.tagName == 'A')"
 									   "        res.linkTitle = e.text;"
-									   "    if (res.linkUrl == ''& & e.tagName == 'A')"
+									   "    if (res.linkUrl == '' && e.tagName == 'A')"
 									   "        res.linkUrl = e.getAttribute('href');"
-									   "    if (res.mediaUrl == ''& & isMediaElement(e)) {"
+									   "    if (res.mediaUrl == '' && isMediaElement(e)) {"
 									   "        res.mediaUrl = e.currentSrc;"
 									   "        res.mediaPaused = e.paused;"
 									   "        res.mediaMuted = e.muted;"
@@ -93,39 +120,7 @@ WebHitTestResult::WebHitTestResult(const WebPage* page, const QPoint& pos) :
 									   "return res;"
 									   "})()");
 
-	WebPage* p = const_cast<WebPage*>(page);
-	m_viewportPos = p->mapToViewport(m_pos);
-
-	const QString& js = source.arg(m_viewportPos.x()).arg(m_viewportPos.y());
-	const QUrl& url{p->url()};
-	const QVariantMap& map{p->executeJavaScript(js, Engine::WebProfile::ScriptWorldId::ApplicationWorld).toMap()};
-
-	if (map.isEmpty())
-		return;
-
-	m_isNull = false;
-	m_baseUrl = map.value(QStringLiteral("baseUrl")).toUrl();
-	m_alternateText = map.value(QStringLiteral("alternateText")).toString();
-	m_imageUrl = map.value(QStringLiteral("imageUrl")).toUrl();
-	m_isContentEditable = map.value(QStringLiteral("contentEditable")).toBool();
-	m_isContentSelected = map.value(QStringLiteral("contentSelected")).toBool();
-	m_linkTitle = map.value(QStringLiteral("linkTitle")).toString();
-	m_linkUrl = map.value(QStringLiteral("linkUrl")).toUrl();
-	m_mediaUrl = map.value(QStringLiteral("mediaUrl")).toUrl();
-	m_mediaPaused = map.value(QStringLiteral("mediaPaused")).toBool();
-	m_mediaMuted = map.value(QStringLiteral("mediaMuted")).toBool();
-	m_tagName = map.value(QStringLiteral("tagName")).toString();
-
-	const QVariantList& rect = map.value(QStringLiteral("boundingRect")).toList();
-	if (rect.size() == 4)
-		m_boundingRect = QRect(rect.at(0).toInt(), rect.at(1).toInt(), rect.at(2).toInt(), rect.at(3).toInt());
-
-	if (!m_imageUrl.isEmpty())
-		m_imageUrl = url.resolved(m_imageUrl);
-	if (!m_linkUrl.isEmpty())
-		m_linkUrl = m_baseUrl.resolved(m_linkUrl);
-	if (!m_mediaUrl.isEmpty())
-		m_mediaUrl = url.resolved(m_mediaUrl);
+	return source.arg(viewportPos.x()).arg(viewportPos.y());
 }
 
 void WebHitTestResult::updateWithContextMenuData(const Engine::ContextMenuData& data)
@@ -38,11 +38,15 @@
 
 namespace Sn {
 
-class WebPage;
-
+/*
+ * Result of WebPage::hitTestContent(), built from the reply of script() which
+ * runs in the application world of the page.
+ */
 class SIELO_SHAREDLIB WebHitTestResult {
 public:
-	WebHitTestResult(const WebPage* page, const QPoint& pos);
+	WebHitTestResult(const QPoint& pos, const QPointF& viewportPos, const QUrl& url, const QVariantMap& map);
+
+	static QString script(const QPointF& viewportPos);
 
 	void updateWithContextMenuData(const Engine::ContextMenuData& data);
 
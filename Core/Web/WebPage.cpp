@@ -28,6 +28,7 @@
 #include <QTimer>
 #include <QDesktopServices>
 #include <QFileInfo>
+#include <QElapsedTimer>
 
 #include <QWebChannel>
 
@@ -80,7 +81,6 @@ QString WebPage::setCSS(const QString& css)
 
 WebPage::WebPage(QObject* parent) :
 	Engine::WebPage(Application::instance()->webProfile(), parent),
-	m_runningLoop(nullptr),
 	m_loadProgress(-1),
 	m_blockAlerts(false),
 	m_secureStatus(false),
@@ -94,6 +94,14 @@ WebPage::WebPage(QObject* parent) :
 	connect(this, &Engine::WebPage::urlChanged, this, &WebPage::urlChanged);
 	connect(this, &Engine::WebPage::featurePermissionRequested, this, &WebPage::featurePermissionRequested);
 	connect(this, &Engine::WebPage::windowCloseRequested, this, &WebPage::windowCloseRequested);
+	connect(this, &Engine::WebPage::linkHovered, this, [this](const QString& link)
+	{
+		m_hoveredLink = QUrl(link);
+	});
+	connect(this, &Engine::WebPage::loadStarted, this, [this]()
+	{
+		m_hoveredLink = QUrl();
+	});
 
 	connect(this, &Engine::WebPage::authenticationRequired, this, [this](const QUrl& url, QAuthenticator* authenticator)
 	{
@@ -123,10 +131,18 @@ WebPage::~WebPage()
 {
 	Application::instance()->plugins()->emitWebPageDeleted(this);
 
-	if (m_runningLoop) {
-		m_runningLoop->exit(1);
-		m_runningLoop = nullptr;
+	for (QFutureInterface<QVariant>& script : m_pendingRequests->scripts) {
+		script.reportCanceled();
+		script.reportFinished();
 	}
+
+	for (QFutureInterface<bool>& print : m_pendingRequests->prints) {
+		print.reportCanceled();
+		print.reportFinished();
+	}
+
+	m_pendingRequests->scripts.clear();
+	m_pendingRequests->prints.clear();
 }
 
 WebView* WebPage::view() const
@@ -134,44 +150,107 @@ WebView* WebPage::view() const
 	return static_cast<WebView*>(Engine::WebPage::view());
 }
 
-bool WebPage::execPrintPage(QPrinter* printer, int timeout)
+QFuture<QVariant> WebPage::runScript(const QString& source, quint32 worldId)
+{
+	return runScripts(QStringList{source}, worldId);
+}
+
+QFuture<QVariant> WebPage::runScripts(const QStringList& sources, quint32 worldId)
 {
-	QPointer<QEventLoop> loop{new QEventLoop};
-	bool result{false};
+	QFutureInterface<QVariant> script{};
+	script.reportStarted();
+
+	const QFuture<QVariant> future{script.future()};
+
+	if (sources.isEmpty()) {
+		script.reportFinished();
+		return future;
+	}
+
+	QStringList expressions{};
+	expressions.reserve(sources.count());
+
+	const bool batched{sources.count() > 1};
+
+	foreach (QString source, sources) {
+		source = source.trimmed();
+
+		while (source.endsWith(QLatin1Char(';')))
+			source.chop(1);
+
+		// In a batch, a script throwing only makes its own result undefined
+		if (batched)
+			expressions.append(QStringLiteral("(function(){try{return (") + source
+							   + QStringLiteral("\n)}catch(e){return undefined}})()"));
+		else
+			expressions.append(QStringLiteral("(") + source + QStringLiteral("\n)"));
+	}
+
+	const QString source{batched ? QStringLiteral("[") + expressions.join(QStringLiteral(",\n")) + QStringLiteral("]") : expressions.first()};
+
+	std::shared_ptr<PendingRequests> pending{m_pendingRequests};
+	const quint64 id{++pending->lastId};
+	pending->scripts.insert(id, script);
 
-	QTimer::singleShot(timeout, loop.data(), &QEventLoop::quit);
+	QElapsedTimer timer{};
+	timer.start();
+
+	runJavaScript(source, worldId, [pending, id, batched, timer](const QVariant& result)
+	{
+		scriptLatency().record(timer.nsecsElapsed());
 
-	print(printer, [loop, &result](bool res) {
-		if (loop && loop->isRunning()) {
-			result = res;
-			loop->quit();
+		if (!pending->scripts.contains(id))
+			return;
+
+		QFutureInterface<QVariant> script{pending->scripts.take(id)};
+
+		if (!script.isCanceled()) {
+			if (batched) {
+				const QVariantList results{result.toList()};
+
+				for (int i{0}; i < results.count(); ++i)
+					script.reportResult(results[i], i);
+			}
+			else
+				script.reportResult(result);
 		}
-	});
 
-	loop->exec();
-	delete loop;
+		script.reportFinished();
+	});
 
-	return result;
+	return future;
 }
 
-QVariant WebPage::executeJavaScript(const QString& scriptSrc, quint32 worldId, int timeout)
+QFuture<bool> WebPage::printPage(QPrinter* printer)
 {
-	QPointer<QEventLoop> loop{new QEventLoop};
-	QVariant result{};
-	QTimer::singleShot(timeout, loop.data(), &QEventLoop::quit);
+	QFutureInterface<bool> print{};
+	print.reportStarted();
+
+	std::shared_ptr<PendingRequests> pending{m_pendingRequests};
+	const quint64 id{++pending->lastId};
+	pending->prints.insert(id, print);
 
-	runJavaScript(scriptSrc, worldId, [loop, &result](const QVariant& res)
+	Engine::WebPage::print(printer, [pending, id](bool success)
 	{
-		if (loop && loop->isRunning()) {
-			result = res;
-			loop->quit();
-		}
+		if (!pending->prints.contains(id))
+			return;
+
+		QFutureInterface<bool> print{pending->prints.take(id)};
+
+		if (!print.isCanceled())
+			print.reportResult(success);
+
+		print.reportFinished();
 	});
 
-	loop->exec();
-	delete loop;
+	return print.future();
+}
+
+LatencyHistogram& WebPage::scriptLatency()
+{
+	static LatencyHistogram latency{};
 
-	return result;
+	return latency;
 }
 
 QPointF WebPage::mapToViewport(const QPointF& pos) const
@@ -179,9 +258,20 @@ QPointF WebPage::mapToViewport(const QPointF& pos) const
 	return QPointF(pos.x() / zoomFactor(), pos.y() / zoomFactor());
 }
 
-WebHitTestResult WebPage::hitTestContent(const QPoint& pos) const
+void WebPage::hitTestContent(const QPoint& pos, const HitTestCallback& callback) const
 {
-	return WebHitTestResult(this, pos);
+	const QPointF viewportPos{mapToViewport(pos)};
+	const QUrl pageUrl{url()};
+
+	WebPage* page{const_cast<WebPage*>(this)};
+	const QFuture<QVariant> future{page->runScript(WebHitTestResult::script(viewportPos),
+												   Engine::WebProfile::ScriptWorldId::ApplicationWorld)};
+
+	whenFinished(future, page, [pos, viewportPos, pageUrl, callback](const QFuture<QVariant>& result)
+	{
+		const QVariantMap map{result.resultCount() > 0 ? result.resultAt(0).toMap() : QVariantMap()};
+		callback(WebHitTestResult(pos, viewportPos, pageUrl, map));
+	});
 }
 
 void WebPage::scroll(int x, int y)
@@ -200,7 +290,7 @@ void WebPage::javaScriptAlert(const QUrl& securityOrigin, const QString& msg)
 {
 	Q_UNUSED(securityOrigin)
 
-	if (m_blockAlerts || m_runningLoop)
+	if (m_blockAlerts)
 		return;
 
 	QString title{tr("JavaScript Alert")};
@@ -218,11 +308,6 @@ void WebPage::javaScriptAlert(const QUrl& securityOrigin, const QString& msg)
 	m_blockAlerts = dialog.isChecked();
 }
 
-bool WebPage::isRunningLoop()
-{
-	return m_runningLoop;
-}
-
 bool WebPage::isLoading() const
 {
 	return m_loadProgress < 100;
@@ -284,31 +369,11 @@ void WebPage::finished()
 			m_fileWatcher->removePaths(m_fileWatcher->files());
 	}
 
-	cleanBlockedObject();
-
 	m_passwordEntries = Application::instance()->autoFill()->completePage(this, url());
 
 	emit pageRendering();
 }
 
-void WebPage::cleanBlockedObject()
-{
-	ADB::Manager* manager = ADB::Manager::instance();
-
-	if (!manager->isEnabled())
-		return;
-
-	const QString elementHiding{manager->elementHidingRules(url())};
-
-	if (!elementHiding.isEmpty())
-		runJavaScript(WebPage::setCSS(elementHiding), Engine::WebProfile::ScriptWorldId::ApplicationWorld);
-
-	const QString siteElementHiding{manager->elementHidingRulesForDomain(url())};
-
-	if (!siteElementHiding.isEmpty())
-		runJavaScript(WebPage::setCSS(siteElementHiding), Engine::WebProfile::ScriptWorldId::ApplicationWorld);
-}
-
 void WebPage::urlChanged(const QUrl& url)
 {
 
@@ -351,7 +416,43 @@ bool WebPage::acceptNavigationRequest(const QUrl& url, NavigationType type, bool
 	if (url.scheme() == QLatin1String("abp") && ADB::Manager::instance()->addSubscriptionFromUrl(url))
 		return false;
 
-	return Engine::WebPage::acceptNavigationRequest(url, type, isMainFrame);
+	const bool accepted{Engine::WebPage::acceptNavigationRequest(url, type, isMainFrame)};
+
+	if (accepted && isMainFrame)
+		updateElementHiding(url);
+
+	return accepted;
+}
+
+void WebPage::updateElementHiding(const QUrl& url)
+{
+	ADB::Manager* manager = ADB::Manager::instance();
+	const QString name{QStringLiteral("_sielo_site_element_hiding")};
+
+	// Only the rules of the domain are injected with the page, the generic ones are a profile script
+	removeScript(name);
+
+	if (!manager->isEnabled())
+		return;
+
+	QString source{};
+	bool runsOnSubFrames{false};
+
+	// A $document exception covers the whole document, the generic rules run in the frames too
+	if (!manager->elementHidingEnabled(url)) {
+		source = Scripts::disableElementHiding(ADB::Manager::elementHidingId());
+		runsOnSubFrames = true;
+	}
+	else {
+		const QString siteElementHiding{manager->elementHidingRulesForDomain(url)};
+
+		if (!siteElementHiding.isEmpty())
+			source = Scripts::elementHiding(siteElementHiding, name);
+	}
+
+	if (!source.isEmpty())
+		insertScript(name, source, Engine::WebProfile::DocumentCreation, Engine::WebProfile::ApplicationWorld,
+					 runsOnSubFrames);
 }
 
 Engine::WebPage* WebPage::createNewWindow(Engine::WebPage::WebWindowType type)
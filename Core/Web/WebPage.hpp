@@ -31,13 +31,22 @@
 #include <QWebEngine/WebProfile.hpp>
 #include <QWebEngine/WebPage.hpp>
 
+#include <functional>
+#include <memory>
+
 #include <QPointF>
 #include <QVariant>
+#include <QUrl>
+#include <QHash>
 
-#include <QEventLoop>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QFutureWatcher>
 
 #include "Password/PasswordManager.hpp"
 
+#include "Network/LatencyHistogram.hpp"
+
 namespace Sn {
 
 class WebView;
@@ -54,20 +63,47 @@ public:
 
 	WebView* view() const;
 
-	bool execPrintPage(QPrinter *printer, int timeout = 1000);
-	QVariant executeJavaScript(const QString& scriptSrc, quint32 worldId = Engine::WebProfile::ScriptWorldId::MainWorld,
-							   int timeout = 500);
+	/*
+	 * Scripts must be expressions, like the ones of Scripts. Batched scripts are sent in
+	 * a single round trip and their results are reported in order, a script throwing
+	 * reports an invalid QVariant. A syntax error still fails the whole batch. Futures are
+	 * canceled when the page is destroyed before the renderer answered.
+	 */
+	QFuture<QVariant> runScript(const QString& source, quint32 worldId = Engine::WebProfile::ScriptWorldId::MainWorld);
+	QFuture<QVariant> runScripts(const QStringList& sources, quint32 worldId = Engine::WebProfile::ScriptWorldId::MainWorld);
+	QFuture<bool> printPage(QPrinter* printer);
+
+	// Round trip time of runScripts(), from the call to the answer of the renderer
+	static LatencyHistogram& scriptLatency();
+
+	// Calls callback on the thread of context once the future is finished, unless context is destroyed before
+	template<typename T, typename Callback>
+	static void whenFinished(const QFuture<T>& future, QObject* context, Callback callback)
+	{
+		QFutureWatcher<T>* watcher{new QFutureWatcher<T>(context)};
+
+		QObject::connect(watcher, &QFutureWatcherBase::finished, context, [watcher, callback]()
+		{
+			callback(watcher->future());
+			watcher->deleteLater();
+		});
+
+		watcher->setFuture(future);
+	}
+
+	using HitTestCallback = std::function<void(const WebHitTestResult&)>;
 
 	QPointF mapToViewport(const QPointF& pos) const;
-	WebHitTestResult hitTestContent(const QPoint& pos) const;
+	void hitTestContent(const QPoint& pos, const HitTestCallback& callback) const;
+
+	// Link under the mouse as last reported by the renderer, known without asking it
+	QUrl hoveredLink() const { return m_hoveredLink; }
 
 	void scroll(int x, int y);
 	void setScrollPosition(const QPointF& pos);
 
 	void javaScriptAlert(const QUrl& securityOrigin, const QString& msg) override;
 	
-	bool isRunningLoop();
-
 	bool isLoading() const;
 
 	void setupWebChannel();
@@ -83,7 +119,6 @@ protected slots:
 	void finished();
 
 private slots:
-	void cleanBlockedObject();
 	void urlChanged(const QUrl& url);
 	void watchedFileChanged(const QString& file);
 	void windowCloseRequested();
@@ -93,11 +128,22 @@ private:
 	bool acceptNavigationRequest(const QUrl& url, Engine::WebPage::NavigationType type, bool isMainFrame) Q_DECL_OVERRIDE;
 	Engine::WebPage* createNewWindow(WebWindowType type) Q_DECL_OVERRIDE;
 
+	void updateElementHiding(const QUrl& url);
+
 	void handleUnknowProtocol(const QUrl& url);
 	void desktopServiceOpen(const QUrl& url);
 
 	DelayedFileWatcher* m_fileWatcher{nullptr};
-	QEventLoop* m_runningLoop{nullptr};
+
+	// Shared with the engine callbacks, which may still run while the page is destroyed
+	struct PendingRequests {
+		QHash<quint64, QFutureInterface<QVariant>> scripts{};
+		QHash<quint64, QFutureInterface<bool>> prints{};
+		quint64 lastId{0};
+	};
+
+	std::shared_ptr<PendingRequests> m_pendingRequests{std::make_shared<PendingRequests>()};
+	QUrl m_hoveredLink{};
 
 	QVector<PasswordEntry> m_passwordEntries;
 
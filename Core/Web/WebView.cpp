@@ -103,8 +103,7 @@ WebView::WebView(QWidget* parent) :
 	connect(this, &Engine::WebView::titleChanged, this, &WebView::sTitleChanged);
 	connect(this, &Engine::WebView::iconChanged, this, &WebView::sIconChanged);
 
-	Settings settings{};
-	m_currentZoomLevel = settings.value("Web-Settings/defaultZoomLevel", WebView::zoomLevels().indexOf(300)).toInt();
+	m_currentZoomLevel = Settings::snapshot()->defaultZoomLevel;
 
 	setAcceptDrops(true);
 
@@ -567,13 +566,15 @@ void WebView::newMousePressEvent(QMouseEvent* event)
 		forward();
 		event->accept();
 		break;
+	// The hovered link is known without a round trip to the renderer, when there is none
+	// the click is left to the page which opens links in new tabs the same way
 	case Qt::MiddleButton:
-		m_clickedUrl = m_page->hitTestContent(event->pos()).linkUrl();
+		m_clickedUrl = m_page->hoveredLink();
 		if (!m_clickedUrl.isEmpty())
 			event->accept();
 		break;
 	case Qt::LeftButton:
-		m_clickedUrl = m_page->hitTestContent(event->pos()).linkUrl();
+		m_clickedUrl = m_page->hoveredLink();
 		break;
 	default:
 		break;
@@ -590,7 +591,7 @@ void WebView::newMouseReleaseEvent(QMouseEvent* event)
 	switch (event->button()) {
 	case Qt::MiddleButton:
 		if (!m_clickedUrl.isEmpty()) {
-			const QUrl newUrl{m_page->hitTestContent(event->pos()).linkUrl()};
+			const QUrl newUrl{m_page->hoveredLink()};
 
 			if (m_clickedUrl == newUrl && isUrlValide(newUrl)) {
 				if (event->modifiers() & Qt::ShiftModifier)
@@ -604,7 +605,7 @@ void WebView::newMouseReleaseEvent(QMouseEvent* event)
 		break;
 	case Qt::LeftButton:
 		if (!m_clickedUrl.isEmpty()) {
-			const QUrl newUrl{m_page->hitTestContent(event->pos()).linkUrl()};
+			const QUrl newUrl{m_page->hoveredLink()};
 
 			if ((m_clickedUrl == newUrl && isUrlValide(newUrl)) && event->modifiers() & Qt::ControlModifier) {
 				if (event->modifiers() & Qt::ShiftModifier)
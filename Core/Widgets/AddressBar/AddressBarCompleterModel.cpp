@@ -26,8 +26,12 @@
 
 #include <QPixmap>
 
+#include <QDateTime>
+
 #include "History/History.hpp"
 
+#include "Utils/IconProvider.hpp"
+
 #include "Web/Tab/WebTab.hpp"
 
 #include "Widgets/Tab/TabWidget.hpp"
@@ -38,8 +42,54 @@
 namespace Sn
 {
 
+// Builds a full-text query where every word is a prefix, returns an empty string if nothing can be matched
+static QString fullTextQuery(const QStringList& words)
+{
+	QStringList terms{};
+
+	foreach (QString word, words) {
+		bool hasToken{false};
+
+		foreach (const QChar& c, word) {
+			if (c.isLetterOrNumber()) {
+				hasToken = true;
+				break;
+			}
+		}
+
+		if (!hasToken)
+			continue;
+
+		word.replace(QLatin1Char('"'), QLatin1String("\"\""));
+		terms.append(QLatin1Char('"') + word + QLatin1String("\"*"));
+	}
+
+	return terms.join(QLatin1Char(' '));
+}
+
 QSqlQuery AddressBarCompleterModel::createHistoryQuery(const QString& searchString, int limit, bool exactMatch)
 {
+	if (SqlDatabase::instance()->isHistoryIndexed()) {
+		const QStringList words{exactMatch ? QStringList(searchString)
+			: searchString.split(QLatin1Char(' '), QString::SkipEmptyParts)};
+		const QString match{fullTextQuery(words)};
+
+		if (!match.isEmpty()) {
+			// bm25 is negative, the more relevant the lower. Boost often and recently visited pages
+			QSqlQuery sqlQuery{SqlDatabase::instance()->preparedQuery(QStringLiteral(
+				"SELECT history.id, history.url, history.title, history.count FROM history_fts "
+				"JOIN history ON history.id = history_fts.rowid WHERE history_fts MATCH ? "
+				"ORDER BY bm25(history_fts, 2.0, 1.0) * (1.0 + MIN(history.count, 100) / 10.0) "
+				"* (CASE WHEN history.date > ? THEN 2.0 ELSE 1.0 END), history.date DESC LIMIT ?"))};
+
+			sqlQuery.addBindValue(match);
+			sqlQuery.addBindValue(QDateTime::currentDateTime().addDays(-7).toMSecsSinceEpoch());
+			sqlQuery.addBindValue(limit);
+
+			return sqlQuery;
+		}
+	}
+
 	QStringList searchList{};
 	QString query{QLatin1String("SELECT id, url, title, count FROM history WHERE ")};
 
@@ -58,8 +108,7 @@ QSqlQuery AddressBarCompleterModel::createHistoryQuery(const QString& searchStri
 
 	query.append(QLatin1String("ORDER BY date DESC LIMIT ?"));
 
-	QSqlQuery sqlQuery{SqlDatabase::instance()->database()};
-	sqlQuery.prepare(query);
+	QSqlQuery sqlQuery{SqlDatabase::instance()->preparedQuery(query)};
 
 	if (exactMatch) {
 		sqlQuery.addBindValue(QString("%%1%").arg(searchString));
@@ -93,8 +142,7 @@ QSqlQuery AddressBarCompleterModel::createDomainQuery(const QString& text)
 
 	query.append(QLatin1String("(url LIKE ? OR url LIKE ?) ORDER BY date DESC LIMIT 1"));
 
-	QSqlQuery sqlQuery{SqlDatabase::instance()->database()};
-	sqlQuery.prepare(query);
+	QSqlQuery sqlQuery{SqlDatabase::instance()->preparedQuery(query)};
 
 	if (withoutWww) {
 		sqlQuery.addBindValue(QString("http://www.%"));
@@ -115,7 +163,15 @@ QSqlQuery AddressBarCompleterModel::createDomainQuery(const QString& text)
 AddressBarCompleterModel::AddressBarCompleterModel(QObject* parent) :
 	QStandardItemModel(parent)
 {
-	// Empty
+	connect(IconProvider::instance(), &IconProvider::iconLoaded, this, [this](const QUrl& url, const QImage& image)
+	{
+		for (int row{0}; row < rowCount(); ++row) {
+			QStandardItem* it{item(row)};
+
+			if (it->data(UrlRole).toUrl() == url)
+				it->setIcon(QPixmap::fromImage(image));
+		}
+	});
 }
 
 void AddressBarCompleterModel::setCompletions(const QList<QStandardItem*>& items)
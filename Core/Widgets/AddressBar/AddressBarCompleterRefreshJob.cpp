@@ -36,6 +36,7 @@
 #include "Bookmarks/BookmarkItem.hpp"
 
 #include "History/History.hpp"
+#include "History/HistoryCompletionIndex.hpp"
 
 #include "Utils/IconProvider.hpp"
 
@@ -50,6 +51,18 @@ AddressBarCompleterRefreshJob::AddressBarCompleterRefreshJob(const QString& sear
 	m_searchString(searchString),
 	m_timestamp(QDateTime::currentMSecsSinceEpoch())
 {
+	// Once the history is in memory the completions are computed right away. Until then, on the
+	// first completions after a start, the history_fts query answers while the index loads
+	HistoryCompletionIndex* index{Application::instance()->history()->completionIndex()};
+
+	if (index->isLoaded()) {
+		completeFromIndex(index);
+		QMetaObject::invokeMethod(this, "slotFinished", Qt::QueuedConnection);
+		return;
+	}
+
+	index->load();
+
 	m_watcher = new QFutureWatcher<void>(this);
 	connect(m_watcher, &QFutureWatcher<void>::finished, this, &AddressBarCompleterRefreshJob::slotFinished);
 
@@ -95,12 +108,50 @@ void AddressBarCompleterRefreshJob::runJob()
 			domainQuery.exec();
 			if (domainQuery.next())
 				m_domainCompletion = createDomainCompletion(domainQuery.value(0).toUrl().host());
+
+			domainQuery.finish();
 		}
 	}
 
 	if (m_jobCancelled)
 		return;
 
+	addVisitSearchItem();
+}
+
+void AddressBarCompleterRefreshJob::completeFromIndex(HistoryCompletionIndex* index)
+{
+	const QVector<HistoryCompletionIndex::Match> matches{m_searchString.isEmpty() ? index->mostVisited(15)
+		: index->complete(m_searchString, 20)};
+
+	foreach (const HistoryCompletionIndex::Match& match, matches) {
+		QStandardItem* item{new QStandardItem()};
+		item->setText(match.url.toEncoded());
+		item->setData(match.id, AddressBarCompleterModel::IdRole);
+		item->setData(match.title, AddressBarCompleterModel::TitleRole);
+		item->setData(match.url, AddressBarCompleterModel::UrlRole);
+		item->setData(match.count, AddressBarCompleterModel::CountRole);
+		item->setData(false, AddressBarCompleterModel::BookmarkRole);
+		item->setData(IconProvider::requestImageForUrl(match.url, true), AddressBarCompleterModel::ImageRole);
+
+		if (!m_searchString.isEmpty())
+			item->setData(m_searchString, AddressBarCompleterModel::SearchStringRole);
+
+		m_items.append(item);
+	}
+
+	if (!m_searchString.isEmpty()) {
+		const QString host{index->domainCompletion(m_searchString)};
+
+		if (!host.isEmpty())
+			m_domainCompletion = createDomainCompletion(host);
+	}
+
+	addVisitSearchItem();
+}
+
+void AddressBarCompleterRefreshJob::addVisitSearchItem()
+{
 	if (!m_searchString.isEmpty()) {
 		QStandardItem* item{new QStandardItem()};
 		item->setText(m_searchString);
@@ -184,8 +235,9 @@ void AddressBarCompleterRefreshJob::completeFromHistory()
 
 void AddressBarCompleterRefreshJob::completeMostVisited()
 {
-	QSqlQuery query{SqlDatabase::instance()->database()};
-	query.exec("SELECT id, url, title FROM history ORDER BY count DESC LIMIT 15");
+	QSqlQuery query{SqlDatabase::instance()->preparedQuery(
+		QStringLiteral("SELECT id, url, title FROM history ORDER BY count DESC LIMIT 15"))};
+	query.exec();
 
 	while (query.next()) {
 		QStandardItem* item{new QStandardItem()};
@@ -33,6 +33,8 @@
 
 namespace Sn
 {
+class HistoryCompletionIndex;
+
 class SIELO_SHAREDLIB AddressBarCompleterRefreshJob: public QObject {
 	Q_OBJECT
 
@@ -62,8 +64,10 @@ private:
 	};
 
 	void runJob();
+	void completeFromIndex(HistoryCompletionIndex* index);
 	void completeFromHistory();
 	void completeMostVisited();
+	void addVisitSearchItem();
 
 	QString createDomainCompletion(const QString &completion) const;
 
@@ -70,6 +70,9 @@
 
 namespace Sn
 {
+// Tabs created per event loop turn while a session is restored
+static const int RESTORE_CHUNK_SIZE = 10;
+
 TabWidget::TabWidget(BrowserWindow* window, Application::TabsSpaceType type, QWidget* parent) :
 	TabStackedWidget(parent),
 	m_saveTimer(new AutoSaver(this)),
@@ -296,18 +299,70 @@ bool TabWidget::restoreState(const QVector<WebTab::SavedTab>& tabs, int currentT
 	if (m_homeUrl.isEmpty())
 		m_homeUrl = m_window->homePageUrl();
 
-	for (WebTab::SavedTab tab : tabs) {
-		int index{addView(QUrl(), Application::NTT_CleanSelectedTab, false, tab.isPinned)};
+	restoreTabs(tabs, currentTab, [this]()
+	{
+		QTimer::singleShot(0, m_tabBar, SLOT(ensureVisible()));
+
+		weTab()->hide();
+		weTab()->show();
+	});
+
+	return true;
+}
+
+void TabWidget::restoreTabs(const QVector<WebTab::SavedTab>& tabs, int currentTab, std::function<void()> finished)
+{
+	finishRestore();
+
+	for (const WebTab::SavedTab& tab : tabs)
+		m_pendingTabs.enqueue(tab);
+
+	m_restoredTabs = 0;
+	m_restoredCurrentTab = qBound(0, currentTab, tabs.count() - 1);
+	m_restoreFinished = finished;
+
+	// The first tabs, and the current one if it is among them, are there when the window shows up
+	restoreNextTabs();
+}
+
+void TabWidget::finishRestore()
+{
+	restorePendingTabs(m_pendingTabs.count());
+}
+
+void TabWidget::restoreNextTabs()
+{
+	restorePendingTabs(RESTORE_CHUNK_SIZE);
+
+	if (!m_pendingTabs.isEmpty())
+		QTimer::singleShot(0, this, &TabWidget::restoreNextTabs);
+}
+
+void TabWidget::restorePendingTabs(int maximum)
+{
+	if (m_pendingTabs.isEmpty())
+		return;
+
+	for (int i{0}; i < maximum && !m_pendingTabs.isEmpty(); ++i) {
+		const WebTab::SavedTab tab{m_pendingTabs.dequeue()};
+		const int index{addView(LoadRequest(), QString(), Application::NTT_CleanNotSelectedTab, false, count(), tab.isPinned)};
+
 		weTab(index)->restoreTab(tab);
+
+		if (m_restoredTabs++ == m_restoredCurrentTab) {
+			setCurrentIndex(index);
+			weTab(index)->tabActivated();
+		}
 	}
 
-	setCurrentIndex(currentTab);
-	QTimer::singleShot(0, m_tabBar, SLOT(ensureVisible()));
+	if (!m_pendingTabs.isEmpty())
+		return;
 
-	weTab()->hide();
-	weTab()->show();
+	std::function<void()> finished{};
+	std::swap(finished, m_restoreFinished);
 
-	return true;
+	if (finished)
+		finished();
 }
 
 void TabWidget::setCurrentIndex(int index)
@@ -30,6 +30,9 @@
 
 #include <QByteArray>
 #include <QVector>
+#include <QQueue>
+
+#include <functional>
 
 #include <QMenu>
 #include <QToolBar>
@@ -74,6 +77,12 @@ public:
 	QByteArray saveState();
 	bool restoreState(const QVector<WebTab::SavedTab>& tabs, int currentTab, const QUrl& homeUrl);
 
+	// Saved tabs are created a few per event loop turn, finished is called once they all exist
+	void restoreTabs(const QVector<WebTab::SavedTab>& tabs, int currentTab, std::function<void()> finished = nullptr);
+	bool isRestoring() const { return !m_pendingTabs.isEmpty(); }
+	// Creates the tabs still waiting to be restored right away
+	void finishRestore();
+
 	void setCurrentIndex(int index);
 	void goToApplication(QWidget* w);
 		
@@ -181,6 +190,8 @@ private slots:
 	void actionChangeIndex();
 	void tabWasMoved(int before, int after);
 
+	void restoreNextTabs();
+
 private:
 	WebTab* weTab() const;
 	WebTab* weTab(int index) const;
@@ -189,6 +200,8 @@ private:
 	bool validIndex(int index) const;
 	void updateClosedTabsButton();
 
+	void restorePendingTabs(int maximum);
+
 	void keyPressEvent(QKeyEvent* event) override;
 	void keyReleaseEvent(QKeyEvent* event) override;
 
@@ -210,6 +223,11 @@ private:
 
 	QPointer<WebTab> m_lastBackgroundTab{};
 
+	QQueue<WebTab::SavedTab> m_pendingTabs{};
+	int m_restoredTabs{0};
+	int m_restoredCurrentTab{-1};
+	std::function<void()> m_restoreFinished{};
+
 	QMenu* m_menuClosedTabs{nullptr};
 	QUrl m_urlOnNewTab{};
 	QUrl m_homeUrl{};
@@ -90,8 +90,7 @@ TabsSpaceSplitter::SavedTabsSpace::SavedTabsSpace(TabsSpaceSplitter* splitter, T
 
 TabsSpaceSplitter::SavedTabsSpace::SavedTabsSpace(MaquetteGridTabsList* maquetteGridTabsList)
 {
-	Settings settings{};
-	int defaultZoomLevel{settings.value("Web-Settings/defaultZoomLevel", WebView::zoomLevels().indexOf(100)).toInt()};
+	const int defaultZoomLevel{Settings::snapshot()->defaultZoomLevel};
 
 	homeUrl = maquetteGridTabsList->manager()->window()->homePageUrl().toString();
 	currentTab = 0;
@@ -217,37 +216,33 @@ bool TabsSpaceSplitter::restoreTabsSpace(const SavedTabsSpace& tabsSpace)
 		return false;
 
 	TabWidget* tabWidget{new TabWidget(m_window)};
+	tabWidget->setHomeUrl(tabsSpace.homeUrl);
 
-	QVector<QPair<WebTab*, QVector<int>>> childTabs{};
+	// Tabs are restored across several event loop turns, the tree needs all of them
+	const QVector<WebTab::SavedTab> tabs{tabsSpace.tabs};
 
-	for (int i{0}; i < tabsSpace.tabs.count(); ++i) {
-		WebTab::SavedTab tab = tabsSpace.tabs[i];
-		WebTab *webTab = tabWidget->webTab(tabWidget->addView(QUrl(), Application::NTT_CleanSelectedTab, false, tab.isPinned));
-		webTab->restoreTab(tab);
-		
-		if (!tab.childTabs.isEmpty()) 
-			childTabs.append({webTab, tab.childTabs});
-	}
+	tabWidget->restoreTabs(tabs, tabsSpace.currentTab, [tabWidget, tabs]()
+	{
+		for (int i{0}; i < tabs.count(); ++i) {
+			WebTab* parentTab{tabWidget->webTab(i)};
+
+			if (!parentTab)
+				continue;
+
+			for (int index : tabs[i].childTabs) {
+				WebTab* childTab{tabWidget->webTab(index)};
 
-	for (const auto p : childTabs) {
-		const auto indices = p.second;
-		
-		for (int index : indices) {
-			WebTab *t = tabWidget->webTab(index);
-			if (t) 
-				p.first->addChildTab(t);
+				if (childTab)
+					parentTab->addChildTab(childTab);
+			}
 		}
-	}
 
-	tabWidget->setCurrentIndex(tabsSpace.currentTab);
-	tabWidget->setHomeUrl(tabsSpace.homeUrl);
-	
-	QTimer::singleShot(0, this, [tabWidget]() {
-		tabWidget->tabBar()->ensureVisible();
+		QTimer::singleShot(0, tabWidget, [tabWidget]()
+		{
+			tabWidget->tabBar()->ensureVisible();
+		});
 	});
 
-	tabWidget->webTab()->tabActivated();
-
 	insertTabsSpace(tabsSpace.x, tabsSpace.y, tabWidget);
 
 	return true;
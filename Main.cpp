@@ -34,6 +34,8 @@
 
 #include "Core/BrowserWindow.hpp"
 
+#include <QWebEngine/UrlSchemeHandler.hpp>
+
 
 
 int main(int argc, char** argv)
@@ -89,6 +91,9 @@ int main(int argc, char** argv)
 	if (settings.value("useSoftwareOpenGL", false).toBool())
 		QCoreApplication::setAttribute(Qt::AA_UseSoftwareOpenGL);
 
+	// Before the web profile is created
+	Engine::UrlSchemeHandler::registerScheme(QByteArrayLiteral("sielo"));
+
 	Sn::Application app(argc, argv);
 
 	if (app.isClosing())
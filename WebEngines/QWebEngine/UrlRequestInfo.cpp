@@ -33,33 +33,58 @@ UrlRequestInfo::UrlRequestInfo(QWebEngineUrlRequestInfo* request) :
 	// Empty
 }
 
+UrlRequestInfo::UrlRequestInfo(const QUrl& requestUrl, const QUrl& firstPartyUrl, ResourceType resourceType) :
+	QObject(),
+	m_requestUrl(requestUrl),
+	m_firstPartyUrl(firstPartyUrl),
+	m_resourceType(resourceType)
+{
+	// Empty
+}
+
 UrlRequestInfo::ResourceType UrlRequestInfo::resourceType() const
 {
+	if (!m_request)
+		return m_resourceType;
+
 	return static_cast<ResourceType>(m_request->resourceType());
 }
 
 QUrl UrlRequestInfo::requestUrl() const
 {
+	if (!m_request)
+		return m_requestUrl;
+
 	return m_request->requestUrl();
 }
 
 void UrlRequestInfo::redirect(const QUrl& url)
 {
-	m_request->redirect(url);
+	m_redirected = true;
+
+	if (m_request)
+		m_request->redirect(url);
 }
 
 void UrlRequestInfo::block(bool shouldBlock)
 {
-	m_request->block(shouldBlock);
+	m_blocked = shouldBlock;
+
+	if (m_request)
+		m_request->block(shouldBlock);
 }
 
 QUrl UrlRequestInfo::firstPartyUrl() const
 {
+	if (!m_request)
+		return m_firstPartyUrl;
+
 	return m_request->firstPartyUrl();
 }
 
 void UrlRequestInfo::setHttpHeader(const QByteArray& name, const QByteArray& value)
 {
-	m_request->setHttpHeader(name, value);
+	if (m_request)
+		m_request->setHttpHeader(name, value);
+}
 }
-}
\ No newline at end of file
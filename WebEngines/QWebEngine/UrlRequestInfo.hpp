@@ -59,6 +59,8 @@ public:
 	};
 
 	UrlRequestInfo(QWebEngineUrlRequestInfo* request);
+	// Request not backed by the engine, used to replay recorded requests
+	UrlRequestInfo(const QUrl& requestUrl, const QUrl& firstPartyUrl, ResourceType resourceType);
 	~UrlRequestInfo() = default;
 
 	void redirect(const QUrl& url);
@@ -68,9 +70,19 @@ public:
 	QUrl requestUrl() const;
 	ResourceType resourceType() const;
 
+	bool isBlocked() const { return m_blocked; }
+	bool isRedirected() const { return m_redirected; }
+
 	void setHttpHeader(const QByteArray& name, const QByteArray& value);
 private:
 	QWebEngineUrlRequestInfo* m_request{nullptr};
+
+	QUrl m_requestUrl{};
+	QUrl m_firstPartyUrl{};
+	ResourceType m_resourceType{ResourceTypeUnknown};
+
+	bool m_blocked{false};
+	bool m_redirected{false};
 };
 }
 
@@ -0,0 +1,59 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "UrlRequestJob.hpp"
+
+#include <QBuffer>
+
+namespace Engine {
+UrlRequestJob::UrlRequestJob(QWebEngineUrlRequestJob* job) :
+	m_job(job)
+{
+	// Empty
+}
+
+QUrl UrlRequestJob::requestUrl() const
+{
+	return m_job->requestUrl();
+}
+
+QByteArray UrlRequestJob::requestMethod() const
+{
+	return m_job->requestMethod();
+}
+
+void UrlRequestJob::reply(const QByteArray& contentType, const QByteArray& data)
+{
+	// The engine reads the device after this returns, it is deleted with the job
+	QBuffer* buffer{new QBuffer(m_job)};
+	buffer->setData(data);
+
+	m_job->reply(contentType, buffer);
+}
+
+void UrlRequestJob::fail(Error error)
+{
+	m_job->fail(static_cast<QWebEngineUrlRequestJob::Error>(error));
+}
+}
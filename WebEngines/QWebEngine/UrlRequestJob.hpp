@@ -0,0 +1,61 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#ifndef SIELO_BROWSER_URLREQUESTJOB_HPP
+#define SIELO_BROWSER_URLREQUESTJOB_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QByteArray>
+#include <QUrl>
+
+#include <QtWebEngineCore/QWebEngineUrlRequestJob>
+
+namespace Engine {
+class SIELO_SHAREDLIB UrlRequestJob {
+public:
+	enum Error {
+		NoError = 0,
+		UrlNotFound = 1,
+		UrlInvalid = 2,
+		RequestAborted = 3,
+		RequestDenied = 4,
+		RequestFailed = 5
+	};
+
+	UrlRequestJob(QWebEngineUrlRequestJob* job);
+	~UrlRequestJob() = default;
+
+	QUrl requestUrl() const;
+	QByteArray requestMethod() const;
+
+	void reply(const QByteArray& contentType, const QByteArray& data);
+	void fail(Error error);
+
+private:
+	QWebEngineUrlRequestJob* m_job{nullptr};
+};
+}
+
+#endif //SIELO_BROWSER_URLREQUESTJOB_HPP
@@ -0,0 +1,62 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#include "UrlSchemeHandler.hpp"
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QtWebEngineCore/QWebEngineUrlScheme>
+#endif
+
+namespace Engine {
+UrlSchemeHandler::UrlSchemeHandler(QObject* parent) :
+	QWebEngineUrlSchemeHandler(parent)
+{
+	// Empty
+}
+
+void UrlSchemeHandler::requestStarted(QWebEngineUrlRequestJob* job)
+{
+	UrlRequestJob request{job};
+	urlRequestStarted(request);
+}
+
+void UrlSchemeHandler::urlRequestStarted(UrlRequestJob& job)
+{
+	job.fail(UrlRequestJob::UrlNotFound);
+}
+
+void UrlSchemeHandler::registerScheme(const QByteArray& name)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+	// Local, so web pages can neither load nor link it
+	QWebEngineUrlScheme scheme{name};
+	scheme.setSyntax(QWebEngineUrlScheme::Syntax::Path);
+	scheme.setFlags(QWebEngineUrlScheme::LocalScheme | QWebEngineUrlScheme::LocalAccessAllowed);
+
+	QWebEngineUrlScheme::registerScheme(scheme);
+#else
+	Q_UNUSED(name)
+#endif
+}
+}
@@ -0,0 +1,49 @@
+/***********************************************************************************
+** MIT License                                                                    **
+**                                                                                **
+** Copyright (c) 2018 Victor DENIS (victordenis01@gmail.com)                      **
+**                                                                                **
+** Permission is hereby granted, free of charge, to any person obtaining a copy   **
+** of this software and associated documentation files (the "Software"), to deal  **
+** in the Software without restriction, including without limitation the rights   **
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      **
+** copies of the Software, and to permit persons to whom the Software is          **
+** furnished to do so, subject to the following conditions:                       **
+**                                                                                **
+** The above copyright notice and this permission notice shall be included in all **
+** copies or substantial portions of the Software.                                **
+**                                                                                **
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     **
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       **
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    **
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         **
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  **
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  **
+** SOFTWARE.                                                                      **
+***********************************************************************************/
+
+#ifndef SIELO_BROWSER_URLSCHEMEHANDLER_HPP
+#define SIELO_BROWSER_URLSCHEMEHANDLER_HPP
+
+#include "SharedDefines.hpp"
+
+#include <QtWebEngineCore/QWebEngineUrlSchemeHandler>
+
+#include "UrlRequestJob.hpp"
+
+namespace Engine {
+class SIELO_SHAREDLIB UrlSchemeHandler: public QWebEngineUrlSchemeHandler {
+	Q_OBJECT
+
+public:
+	UrlSchemeHandler(QObject* parent = nullptr);
+
+	void requestStarted(QWebEngineUrlRequestJob* job) Q_DECL_OVERRIDE;
+	virtual void urlRequestStarted(UrlRequestJob& job);
+
+	// Declares an internal scheme web pages can't load, must be called before any web profile is created
+	static void registerScheme(const QByteArray& name);
+};
+}
+
+#endif //SIELO_BROWSER_URLSCHEMEHANDLER_HPP
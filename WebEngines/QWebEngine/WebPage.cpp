@@ -24,6 +24,9 @@
 
 #include "WebPage.hpp"
 
+#include <QtWebEngineWidgets/QWebEngineScript>
+#include <QtWebEngineWidgets/QWebEngineScriptCollection>
+
 namespace Engine {
 
 WebPage::WebPage(QObject* parent) :
@@ -65,6 +68,28 @@ WebView* WebPage::view() const
 	return qobject_cast<WebView*>(QWebEnginePage::view());
 }
 
+void WebPage::insertScript(QString name, QString source, Engine::WebProfile::ScriptInjectionPoint injectionPoint,
+						   Engine::WebProfile::ScriptWorldId worldId, bool runsOnSubFrames)
+{
+	QWebEngineScript script{};
+
+	script.setName(name);
+	script.setInjectionPoint(static_cast<QWebEngineScript::InjectionPoint>(injectionPoint));
+	script.setWorldId(static_cast<QWebEngineScript::ScriptWorldId>(worldId));
+	script.setRunsOnSubFrames(runsOnSubFrames);
+	script.setSourceCode(source);
+
+	scripts().insert(script);
+}
+
+void WebPage::removeScript(const QString& name)
+{
+	const QList<QWebEngineScript> found{scripts().findScripts(name)};
+
+	for (const QWebEngineScript& script : found)
+		scripts().remove(script);
+}
+
 QWebEnginePage* WebPage::createWindow(QWebEnginePage::WebWindowType type)
 {
 	return qobject_cast<QWebEnginePage*>(createNewWindow(type));
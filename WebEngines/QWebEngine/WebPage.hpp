@@ -48,6 +48,10 @@ public:
 	WebHistory* history() const;
 	WebView* view() const;
 
+	void insertScript(QString name, QString source, WebProfile::ScriptInjectionPoint injectionPoint,
+					  WebProfile::ScriptWorldId worldId, bool runsOnSubFrames);
+	void removeScript(const QString& name);
+
 	QWebEnginePage* createWindow(WebWindowType type) Q_DECL_OVERRIDE;
 	virtual Engine::WebPage* createNewWindow(WebWindowType type);
 
@@ -65,6 +65,14 @@ void WebProfile::insertScript(QString name, QString source, Engine::WebProfile::
 	scripts()->insert(script);
 }
 
+void WebProfile::removeScript(const QString& name)
+{
+	const QList<QWebEngineScript> found{scripts()->findScripts(name)};
+
+	for (const QWebEngineScript& script : found)
+		scripts()->remove(script);
+}
+
 WebSettings* WebProfile::settings() const
 {
 	return new WebSettings(QWebEngineProfile::settings());
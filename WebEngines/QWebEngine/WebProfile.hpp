@@ -56,6 +56,7 @@ public:
 
 	void insertScript(QString name, QString source, ScriptInjectionPoint injectionPoint, ScriptWorldId worldId,
 					  bool runsOnSubFrames);
+	void removeScript(const QString& name);
 
 	WebSettings* settings() const;
 	CookieStore* cookieStore();